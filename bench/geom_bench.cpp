@@ -0,0 +1,251 @@
+/// geom kernel benchmarks with hardware counters (Linux perf_event_open)
+/// usage: geom_bench [elements] [repeats]
+/// counters may be unavailable (kernel.perf_event_paranoid, containers), wall time is always reported
+
+#include "include/geom.h"
+#include "include/geom_simd.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// one counter group read at once so all counters cover the same instructions
+class perf_counters {
+public:
+	static constexpr std::size_t count = 5;
+	static constexpr std::array<const char *, count> names{"cycles", "instr", "br-miss", "L1D-miss", "LLC-miss"};
+
+	perf_counters() {
+		const std::array<std::pair<std::uint32_t, std::uint64_t>, count> events{{
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+			{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+			{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		}};
+		for (std::size_t i = 0; i < count; ++i) {
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = events[i].first;
+			attr.config = events[i].second;
+			attr.disabled = fds[0] < 0 ? 1 : 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, fds[0], 0));
+			if (fds[i] < 0) {
+				if (i == 0)
+					return; /// no group without a leader
+				continue;
+			}
+			ioctl(fds[i], PERF_EVENT_IOC_ID, &ids[i]);
+		}
+	}
+	~perf_counters() {
+		for (const int fd : fds)
+			if (fd >= 0)
+				close(fd);
+	}
+	perf_counters(const perf_counters &) = delete;
+	perf_counters & operator=(const perf_counters &) = delete;
+
+	[[nodiscard]] bool available() const noexcept { return fds[0] >= 0; }
+
+	void start() noexcept {
+		if (!available())
+			return;
+		ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+
+	/// counter values scaled for multiplexing, -1 for counters that failed to open
+	std::array<double, count> stop() noexcept {
+		std::array<double, count> v;
+		v.fill(-1.0);
+		if (!available())
+			return v;
+		ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+		struct { std::uint64_t nr, enabled, running; struct { std::uint64_t value, id; } values[count]; } data{};
+		if (read(fds[0], &data, sizeof(data)) <= 0 || data.running == 0)
+			return v;
+		const double scale = static_cast<double>(data.enabled) / static_cast<double>(data.running);
+		for (std::uint64_t k = 0; k < data.nr && k < count; ++k)
+			for (std::size_t i = 0; i < count; ++i)
+				if (fds[i] >= 0 && ids[i] == data.values[k].id)
+					v[i] = static_cast<double>(data.values[k].value) * scale;
+		return v;
+	}
+
+private:
+	std::array<int, count> fds{-1, -1, -1, -1, -1};
+	std::array<std::uint64_t, count> ids{};
+};
+
+/// keeps results alive without a memory barrier per element
+template <typename T>
+inline void keep(const T & v) { asm volatile("" : : "g"(&v) : "memory"); }
+
+struct kernel {
+	std::string name;
+	std::string variant;
+	std::function<void()> run; /// processes all elements once
+};
+
+struct dataset {
+	std::vector<geom::rectf> a, b;
+	std::vector<geom::recti> ai, bi;
+	std::vector<geom::sizeu> sz, bounds;
+	std::vector<geom::pointi> pts;
+};
+
+dataset make_data(std::size_t n) {
+	dataset d;
+	std::mt19937 g(12345);
+	std::uniform_int_distribution<int> pos(0, 1000), ext(1, 200);
+	std::uniform_int_distribution<unsigned> sz(1, 4096);
+	for (std::size_t i = 0; i < n; ++i) {
+		const int x1 = pos(g), y1 = pos(g), x2 = pos(g), y2 = pos(g);
+		d.ai.push_back(geom::recti::from_size(x1, y1, ext(g), ext(g)));
+		d.bi.push_back(geom::recti::from_size(x2, y2, ext(g), ext(g)));
+		d.a.push_back(d.ai.back().cast<float>());
+		d.b.push_back(d.bi.back().cast<float>());
+		d.sz.push_back(geom::sizeu{sz(g), sz(g)});
+		d.bounds.push_back(geom::sizeu{sz(g), sz(g)});
+		d.pts.push_back(geom::pointi{pos(g), pos(g)});
+	}
+	return d;
+}
+
+std::vector<kernel> make_kernels(const dataset & d) {
+	const std::size_t n = d.a.size();
+	std::vector<kernel> k;
+	k.push_back({"intersected", "optional", [&d, n] {
+		float s = 0.f;
+		for (std::size_t i = 0; i < n; ++i)
+			if (const auto r = d.a[i].intersected(d.b[i]))
+				s += r->left();
+		keep(s);
+	}});
+	k.push_back({"intersected", "intersect_raw", [&d, n] {
+		float s = 0.f;
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto r = geom::intersect_raw(d.a[i], d.b[i]);
+			s += r.valid ? r.r.left() : 0.f;
+		}
+		keep(s);
+	}});
+	k.push_back({"intersected", "packed_rect", [&d, n] {
+		float s = 0.f;
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto r = geom::packed_rectf(d.a[i]).intersected(geom::packed_rectf(d.b[i]));
+			s += r.valid() ? r.left() : 0.f;
+		}
+		keep(s);
+	}});
+	k.push_back({"overlap area", "optional", [&d, n] {
+		std::uint64_t s = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			if (const auto r = d.ai[i].intersected(d.bi[i]))
+				s += static_cast<std::uint64_t>(r->width()) * static_cast<std::uint64_t>(r->height());
+		keep(s);
+	}});
+	k.push_back({"overlap area", "intersection_area", [&d, n] {
+		std::uint64_t s = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			s += geom::intersection_area(d.ai[i], d.bi[i]);
+		keep(s);
+	}});
+	/// both iou variants score d.a[0] against every box, the bulk overload is one to many
+	k.push_back({"iou", "scalar", [&d, n] {
+		float s = 0.f;
+		for (std::size_t i = 0; i < n; ++i)
+			s += geom::iou(d.a[0], d.b[i]);
+		keep(s);
+	}});
+	k.push_back({"iou", "bulk", [&d, n] {
+		static std::vector<float> out;
+		out.resize(n);
+		geom::iou(d.a[0], std::span<const geom::rectf>(d.b), out);
+		keep(out[n - 1]);
+	}});
+	k.push_back({"contains(point)", "scalar", [&d, n] {
+		unsigned s = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			s += d.ai[i].contains(d.pts[i]);
+		keep(s);
+	}});
+	k.push_back({"size::fitted", "scalar", [&d, n] {
+		unsigned s = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			s += d.sz[i].fitted(d.bounds[i]).width;
+		keep(s);
+	}});
+	k.push_back({"nearest_mip_level", "scalar", [&d, n] {
+		unsigned s = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			s += geom::nearest_mip_level(d.sz[i], d.bounds[i]);
+		keep(s);
+	}});
+	return k;
+}
+
+} //ns
+
+int main(int argc, char ** argv) {
+	const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 20;
+	const unsigned repeats = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 10u;
+	if (n == 0 || repeats == 0) {
+		std::fprintf(stderr, "usage: %s [elements] [repeats]\n", argv[0]);
+		return 1;
+	}
+	const auto data = make_data(n);
+	const auto kernels = make_kernels(data);
+	perf_counters pc;
+	if (!pc.available())
+		std::fprintf(stderr, "perf_event_open failed, hardware counters disabled\n");
+
+	std::printf("%-18s %-18s %9s", "kernel", "variant", "ns/elem");
+	for (const auto * name : perf_counters::names)
+		std::printf(" %9s", name);
+	std::printf("\n");
+	for (const auto & k : kernels) {
+		k.run(); /// warm up caches and branch predictors
+		std::array<double, perf_counters::count> best;
+		best.fill(-1.0);
+		double best_ns = 0.0;
+		for (unsigned r = 0; r < repeats; ++r) {
+			const auto t0 = std::chrono::steady_clock::now();
+			pc.start();
+			k.run();
+			const auto c = pc.stop();
+			const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+			/// keep the fastest run, it has the least interference
+			if (r == 0 || ns < best_ns) {
+				best_ns = ns;
+				best = c;
+			}
+		}
+		std::printf("%-18s %-18s %9.3f", k.name.c_str(), k.variant.c_str(), best_ns / static_cast<double>(n));
+		for (const double c : best) {
+			if (c < 0.0)
+				std::printf(" %9s", "n/a");
+			else
+				std::printf(" %9.3f", c / static_cast<double>(n));
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,248 @@
+/// replays a geom operation trace (see geom_trace.h) against alternative implementations
+/// usage: geom_replay trace.bin [repeats]
+
+#include "include/geom.h"
+#include "include/geom_simd.h"
+#include "include/geom_trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using geom::trace::op_code;
+using geom::trace::scalar;
+
+template <typename T>
+T get(const unsigned char *& p) noexcept {
+	T v;
+	std::memcpy(&v, p, sizeof(T));
+	p += sizeof(T);
+	return v;
+}
+
+template <typename T, typename S>
+geom::rect<T, S> get_rect(const unsigned char *& p) {
+	const T x1 = get<T>(p), y1 = get<T>(p), x2 = get<T>(p), y2 = get<T>(p);
+	return geom::rect<T, S>(x1, y1, x2, y2);
+}
+
+template <typename T>
+geom::size<T> get_size(const unsigned char *& p) noexcept {
+	const T w = get<T>(p), h = get<T>(p);
+	return geom::size<T>{w, h};
+}
+
+template <typename T>
+inline void keep(const T & v) { asm volatile("" : : "g"(&v) : "memory"); }
+
+struct variant {
+	std::string op, impl, types;
+	std::size_t count;
+	std::function<void()> run;
+};
+
+/// operations of one rect<T, S> type grouped by op code
+template <typename T, typename S>
+struct typed_ops {
+	using rect_t = geom::rect<T, S>;
+	std::vector<std::pair<rect_t, rect_t>> intersected, united, contains_rect, intersect_raw, intersection_area;
+	std::vector<std::pair<rect_t, geom::point<T>>> contains_point;
+	std::vector<std::pair<rect_t, geom::size<S>>> fit_rect;
+	std::vector<std::pair<geom::size<T>, geom::size<T>>> fitted, nearest_mip_level;
+
+	void read(op_code op, const unsigned char * p) {
+		switch (op) {
+		case op_code::intersected: { auto a = get_rect<T, S>(p); intersected.emplace_back(a, get_rect<T, S>(p)); break; }
+		case op_code::united: { auto a = get_rect<T, S>(p); united.emplace_back(a, get_rect<T, S>(p)); break; }
+		case op_code::contains_rect: { auto a = get_rect<T, S>(p); contains_rect.emplace_back(a, get_rect<T, S>(p)); break; }
+		case op_code::intersect_raw: { auto a = get_rect<T, S>(p); intersect_raw.emplace_back(a, get_rect<T, S>(p)); break; }
+		case op_code::intersection_area: { auto a = get_rect<T, S>(p); intersection_area.emplace_back(a, get_rect<T, S>(p)); break; }
+		case op_code::contains_point: { auto a = get_rect<T, S>(p); const T x = get<T>(p); contains_point.emplace_back(a, geom::point<T>{x, get<T>(p)}); break; }
+		case op_code::fit_rect: { auto a = get_rect<T, S>(p); fit_rect.emplace_back(a, get_size<S>(p)); break; }
+		case op_code::fitted: { auto a = get_size<T>(p); fitted.emplace_back(a, get_size<T>(p)); break; }
+		case op_code::nearest_mip_level: { auto a = get_size<T>(p); nearest_mip_level.emplace_back(a, get_size<T>(p)); break; }
+		}
+	}
+
+	void variants(std::vector<variant> & out, const std::string & types) const {
+		const auto add = [&](const char * op, const char * impl, std::size_t n, std::function<void()> f) {
+			if (n != 0)
+				out.push_back({op, impl, types, n, std::move(f)});
+		};
+		/// every recorded overlap query is replayed through each implementation
+		std::vector<std::pair<rect_t, rect_t>> overlap = intersected;
+		overlap.insert(overlap.end(), intersect_raw.begin(), intersect_raw.end());
+		const auto ov = std::make_shared<std::vector<std::pair<rect_t, rect_t>>>(std::move(overlap));
+		add("intersected", "optional", ov->size(), [ov] {
+			unsigned s = 0;
+			for (const auto & [a, b] : *ov)
+				s += a.intersected(b).has_value();
+			keep(s);
+		});
+		add("intersected", "intersect_raw", ov->size(), [ov] {
+			unsigned s = 0;
+			for (const auto & [a, b] : *ov)
+				s += geom::intersect_raw(a, b).valid;
+			keep(s);
+		});
+		if constexpr (std::is_same_v<T, int> || std::is_same_v<T, float>) {
+			add("intersected", "packed_rect", ov->size(), [ov] {
+				unsigned s = 0;
+				for (const auto & [a, b] : *ov)
+					s += geom::packed_rect<T>(a).intersected(geom::packed_rect<T>(b)).valid();
+				keep(s);
+			});
+			add("contains(rect)", "packed_rect", contains_rect.size(), [this] {
+				unsigned s = 0;
+				for (const auto & [a, b] : contains_rect)
+					s += geom::packed_rect<T>(a).contains(geom::packed_rect<T>(b));
+				keep(s);
+			});
+		}
+		add("united", "rect", united.size(), [this] {
+			T s{};
+			for (const auto & [a, b] : united)
+				s += a.united(b).left();
+			keep(s);
+		});
+		add("contains(rect)", "rect", contains_rect.size(), [this] {
+			unsigned s = 0;
+			for (const auto & [a, b] : contains_rect)
+				s += a.contains(b);
+			keep(s);
+		});
+		add("contains(point)", "rect", contains_point.size(), [this] {
+			unsigned s = 0;
+			for (const auto & [a, p] : contains_point)
+				s += a.contains(p);
+			keep(s);
+		});
+		add("intersection_area", "optional", intersection_area.size(), [this] {
+			geom::area_t<S> s{};
+			for (const auto & [a, b] : intersection_area)
+				if (const auto r = a.intersected(b))
+					s += geom::area(*r);
+			keep(s);
+		});
+		add("intersection_area", "branchless", intersection_area.size(), [this] {
+			geom::area_t<S> s{};
+			for (const auto & [a, b] : intersection_area)
+				s += geom::intersection_area(a, b);
+			keep(s);
+		});
+		add("fit_rect", "fit_rect", fit_rect.size(), [this] {
+			T s{};
+			for (const auto & [b, sz] : fit_rect)
+				s += geom::fit_rect(sz, b).left();
+			keep(s);
+		});
+		add("fitted", "size::fitted", fitted.size(), [this] {
+			T s{};
+			for (const auto & [a, b] : fitted)
+				s += a.fitted(b).width;
+			keep(s);
+		});
+		if constexpr (std::is_unsigned_v<T>) {
+			add("nearest_mip_level", "geom", nearest_mip_level.size(), [this] {
+				unsigned s = 0;
+				for (const auto & [a, b] : nearest_mip_level)
+					s += geom::nearest_mip_level(a, b);
+				keep(s);
+			});
+		}
+	}
+};
+
+struct trace_data {
+	typed_ops<int, int> ii;
+	typed_ops<int, unsigned> in;
+	typed_ops<unsigned, unsigned> uu;
+	typed_ops<float, float> ff;
+	std::size_t records = 0, skipped = 0;
+};
+
+bool load(const char * path, trace_data & d) {
+	std::FILE * f = std::fopen(path, "rb");
+	if (!f)
+		return false;
+	std::vector<unsigned char> buf;
+	unsigned char chunk[1 << 16];
+	for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), f)) != 0;)
+		buf.insert(buf.end(), chunk, chunk + n);
+	std::fclose(f);
+	if (buf.size() < sizeof(geom::trace::magic) || std::memcmp(buf.data(), geom::trace::magic, sizeof(geom::trace::magic)) != 0)
+		return false;
+	constexpr auto code = [](scalar t, scalar s) { return static_cast<unsigned>(t) | (static_cast<unsigned>(s) << 4); };
+	for (std::size_t i = sizeof(geom::trace::magic); i + 2 <= buf.size();) {
+		const auto op = static_cast<op_code>(buf[i]);
+		const unsigned types = buf[i + 1];
+		/// the operand size depends on the op, an unknown code leaves the rest unparsable
+		if (!geom::trace::known(op) || !geom::trace::known(static_cast<scalar>(types & 15u)) || !geom::trace::known(static_cast<scalar>(types >> 4)))
+			throw std::runtime_error("unknown op or scalar code at offset " + std::to_string(i));
+		const std::size_t n = geom::trace::operand_size(op);
+		if (i + 2 + n > buf.size())
+			break; /// truncated tail
+		const unsigned char * p = buf.data() + i + 2;
+		switch (types) {
+		case code(scalar::i32, scalar::i32): d.ii.read(op, p); break;
+		case code(scalar::i32, scalar::u32): d.in.read(op, p); break;
+		case code(scalar::u32, scalar::u32): d.uu.read(op, p); break;
+		case code(scalar::f32, scalar::f32): d.ff.read(op, p); break;
+		default: ++d.skipped; break;
+		}
+		++d.records;
+		i += 2 + n;
+	}
+	return true;
+}
+
+} //ns
+
+int main(int argc, char ** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s trace.bin [repeats]\n", argv[0]);
+		return 1;
+	}
+	const unsigned repeats = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 5u;
+	trace_data d;
+	try {
+		if (!load(argv[1], d)) {
+			std::fprintf(stderr, "%s is not a geom trace\n", argv[1]);
+			return 1;
+		}
+	} catch (const std::exception & e) {
+		std::fprintf(stderr, "bad trace record: %s\n", e.what());
+		return 1;
+	}
+	std::printf("%zu records, %zu of unsupported types\n", d.records, d.skipped);
+
+	std::vector<variant> vs;
+	d.ii.variants(vs, "recti");
+	d.in.variants(vs, "rectn");
+	d.uu.variants(vs, "rectu");
+	d.ff.variants(vs, "rectf");
+
+	std::printf("%-18s %-6s %-14s %10s %9s %10s\n", "op", "type", "impl", "count", "ns/op", "Mops/s");
+	for (const auto & v : vs) {
+		v.run();
+		double best = 0.0;
+		for (unsigned r = 0; r < std::max(repeats, 1u); ++r) {
+			const auto t0 = std::chrono::steady_clock::now();
+			v.run();
+			const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+			if (r == 0 || ns < best)
+				best = ns;
+		}
+		const double per = best / static_cast<double>(v.count);
+		std::printf("%-18s %-6s %-14s %10zu %9.3f %10.1f\n", v.op.c_str(), v.types.c_str(), v.impl.c_str(), v.count, per, 1e3 / per);
+	}
+	return 0;
+}
@@ -11,9 +11,18 @@
 #include <cmath> /// for lroundf
 #include <stdexcept>
 #include <bit> /// for countl_zero
+#include <span> /// for bulk functions
 
 /// point, size, rect classes
 
+/// define GEOM_TRACE to record operations, see geom_trace.h
+#ifdef GEOM_TRACE
+#include "geom_trace.h"
+#define GEOM_TRACE_OP(op, ...) do { if (!std::is_constant_evaluated()) ::geom::trace::record(::geom::trace::op_code::op, __VA_ARGS__); } while (false)
+#else
+#define GEOM_TRACE_OP(op, ...) do {} while (false)
+#endif
+
 namespace geom {
 
 template <std::floating_point T>
@@ -179,6 +188,7 @@ public:
 	size<U> round() const;
 
 	[[nodiscard]] inline size<T> fitted(size<T> bounds) const {
+		GEOM_TRACE_OP(fitted, *this, bounds);
 		const float zw = (float) bounds.width / width;
 		const float zh = (float) bounds.height / height;
 		if (zw < zh) {
@@ -232,6 +242,33 @@ using sizeu = size<unsigned int>;
 using sizef = size<float>;
 
 
+/// distances from each edge, e.g. widget borders or padding
+template <typename T>
+struct insets {
+	using value_type = T;
+	T left, top, right, bottom;
+
+	[[nodiscard]] static constexpr inline insets uniform(T d) noexcept { return insets{d, d, d, d}; }
+	[[nodiscard]] inline constexpr T horizontal() const noexcept { return left + right; }
+	[[nodiscard]] inline constexpr T vertical() const noexcept { return top + bottom; }
+	[[nodiscard]] inline constexpr bool empty() const noexcept { return left == T{} && top == T{} && right == T{} && bottom == T{}; }
+	template<typename U>
+	[[nodiscard]] constexpr insets<U> cast() const noexcept {
+		return insets<U>{ static_cast<U>(left), static_cast<U>(top), static_cast<U>(right), static_cast<U>(bottom) };
+	}
+	inline constexpr insets<T> & operator+=(const insets<T> & rhs) noexcept {
+		left += rhs.left; top += rhs.top; right += rhs.right; bottom += rhs.bottom;
+		return *this;
+	}
+	[[nodiscard]] friend inline constexpr insets<T> operator+(insets<T> lhs, const insets<T> & rhs) noexcept { lhs += rhs; return lhs; }
+	[[nodiscard]] friend inline constexpr bool operator==(const insets<T> &, const insets<T> &) = default;
+};
+
+using insetsi = insets<int>;
+using insetsu = insets<unsigned int>;
+using insetsf = insets<float>;
+
+
 template <typename T, typename S = T>
 class rect {
 public:
@@ -297,9 +334,13 @@ public:
 		};
 	}
 	[[nodiscard]] inline constexpr bool empty() const noexcept { return x2 == x1 || y2 == y1; }
-	[[nodiscard]] inline constexpr bool contains(T x, T y) const noexcept { return x1 <= x && x < x2 && y1 <= y && y < y2; }
+	[[nodiscard]] inline constexpr bool contains(T x, T y) const noexcept {
+		GEOM_TRACE_OP(contains_point, *this, x, y);
+		return x1 <= x && x < x2 && y1 <= y && y < y2;
+	}
 	[[nodiscard]] inline constexpr bool contains(const point<T> & pt) const noexcept { return contains(pt.x, pt.y); }
 	[[nodiscard]] inline constexpr bool contains(const geom::rect<T, S> & inner) const noexcept {
+		GEOM_TRACE_OP(contains_rect, *this, inner);
 		return inner.x1 >= x1 && inner.y1 >= y1 && inner.x2 <= x2 && inner.y2 <= y2;
 	}
 	[[nodiscard]] inline constexpr rect<T, S> translated(T dx, T dy) const noexcept {
@@ -316,7 +357,18 @@ public:
 		return rect<T, S>(x1 - d, y1 - d, x2 + d, y2 + d);
 	}
 	[[nodiscard]] inline constexpr rect<T, S> shrinked(T d) const noexcept { return expanded(-d); }
+	/// moves each edge inwards by its inset, throws for unsigned S when the insets exceed the size
+	template <typename U>
+	[[nodiscard]] inline constexpr rect<T, S> deflated(const insets<U> & in) const {
+		return rect<T, S>(x1 + static_cast<T>(in.left), y1 + static_cast<T>(in.top), x2 - static_cast<T>(in.right), y2 - static_cast<T>(in.bottom));
+	}
+	/// moves each edge outwards by its inset, negative insets move it inwards and throw like deflated
+	template <typename U>
+	[[nodiscard]] inline constexpr rect<T, S> inflated(const insets<U> & in) const {
+		return rect<T, S>(x1 - static_cast<T>(in.left), y1 - static_cast<T>(in.top), x2 + static_cast<T>(in.right), y2 + static_cast<T>(in.bottom));
+	}
 	[[nodiscard]] inline constexpr rect<T, S> united(const rect<T, S> & other) const {
+		GEOM_TRACE_OP(united, *this, other);
 		if (empty())
 			return other;
 		if (other.empty())
@@ -349,6 +401,7 @@ public:
 		return r;
 	}
 	[[nodiscard]] inline constexpr std::optional<rect<T, S>> intersected(const rect<T, S> & other) const {
+		GEOM_TRACE_OP(intersected, *this, other);
 		if (other.x1 >= x2 || other.x2 <= x1 || other.y1 >= y2 || other.y2 <= y1)
 			return std::nullopt;
 		return rect<T, S>(std::max(x1, other.x1), std::max(y1, other.y1),
@@ -365,7 +418,7 @@ public:
 		return rect<T2, S2>{static_cast<T2>(x1), static_cast<T2>(y1), static_cast<T2>(x2), static_cast<T2>(y2)};
 	}
 
-	[[nodiscard]] rect<T, S> operator-(const geom::size<S> & sz) { return rect<T, S>(x1, y1, x2 - sz.width(), y2 - sz.height()); }
+	[[nodiscard]] rect<T, S> operator-(const geom::size<S> & sz) { return rect<T, S>(x1, y1, x2 - sz.width, y2 - sz.height); }
 
 	[[nodiscard]] friend inline constexpr bool operator==(const rect<T, S> & lhs, const rect<T, S> & rhs) {
 		return lhs.x1 == rhs.x1 && lhs.y1 == rhs.y1 && lhs.x2 == rhs.x2 && lhs.y2 == rhs.y2;
@@ -428,8 +481,91 @@ inline rect<T, S> unite(const std::optional<rect<T, S>> & a, const rect<T, S> &
 	return a->united(b);
 }
 
+/// calls f with the parts of a not covered by b, at most 4 non-overlapping non-empty rects:
+/// full width strips above and below b, then the strips left and right of b
+template <typename T, typename S, typename F>
+inline constexpr void for_each_difference(const rect<T, S> & a, const rect<T, S> & b, F && f) {
+	const T x1 = std::max(a.left(), b.left());
+	const T y1 = std::max(a.top(), b.top());
+	const T x2 = std::min(a.right(), b.right());
+	const T y2 = std::min(a.bottom(), b.bottom());
+	if (x1 >= x2 || y1 >= y2) {
+		if (!a.empty())
+			f(a);
+		return;
+	}
+	if (a.top() < y1)
+		f(rect<T, S>(a.left(), a.top(), a.right(), y1));
+	if (y2 < a.bottom())
+		f(rect<T, S>(a.left(), y2, a.right(), a.bottom()));
+	if (a.left() < x1)
+		f(rect<T, S>(a.left(), y1, x1, y2));
+	if (x2 < a.right())
+		f(rect<T, S>(x2, y1, a.right(), y2));
+}
+
+/// area type of rect<T, S>, integer areas are widened to avoid overflow
+template <typename S>
+using area_t = std::conditional_t<std::is_floating_point_v<S>, S, std::uint64_t>;
+
+template <typename T, typename S>
+struct raw_intersection {
+	rect<T, S> r;
+	bool valid; /// true for non-empty overlap
+};
+
+/// intersected() without std::optional and without the early return
+/// the rect may be inverted when there is no overlap, for unsigned size it collapses to empty instead
+template <typename T, typename S>
+[[nodiscard]] inline constexpr raw_intersection<T, S> intersect_raw(const rect<T, S> & a, const rect<T, S> & b) noexcept {
+	GEOM_TRACE_OP(intersect_raw, a, b);
+	const T x1 = std::max(a.left(), b.left());
+	const T y1 = std::max(a.top(), b.top());
+	T x2 = std::min(a.right(), b.right());
+	T y2 = std::min(a.bottom(), b.bottom());
+	const bool valid = (x1 < x2) & (y1 < y2);
+	if constexpr (std::is_unsigned_v<S>) {
+		x2 = std::max(x1, x2);
+		y2 = std::max(y1, y2);
+	}
+	return { rect<T, S>(x1, y1, x2, y2), valid };
+}
+
+/// area of the overlap clamped to zero, no branches
+template <typename T, typename S>
+[[nodiscard]] inline constexpr area_t<S> intersection_area(const rect<T, S> & a, const rect<T, S> & b) noexcept {
+	GEOM_TRACE_OP(intersection_area, a, b);
+	const T x1 = std::max(a.left(), b.left());
+	const T y1 = std::max(a.top(), b.top());
+	const T x2 = std::max(std::min(a.right(), b.right()), x1);
+	const T y2 = std::max(std::min(a.bottom(), b.bottom()), y1);
+	return static_cast<area_t<S>>(static_cast<S>(x2 - x1)) * static_cast<area_t<S>>(static_cast<S>(y2 - y1));
+}
+
+template <typename T, typename S>
+[[nodiscard]] inline constexpr area_t<S> area(const rect<T, S> & r) noexcept {
+	return static_cast<area_t<S>>(static_cast<S>(r.right() - r.left())) * static_cast<area_t<S>>(static_cast<S>(r.bottom() - r.top()));
+}
+
+/// intersection over union, 0 when both rects are empty
+template <typename T, typename S>
+[[nodiscard]] inline constexpr float iou(const rect<T, S> & a, const rect<T, S> & b) noexcept {
+	const auto i = intersection_area(a, b);
+	const auto u = static_cast<float>(area(a) + area(b) - i);
+	return u > 0.f ? static_cast<float>(i) / u : 0.f;
+}
+
+/// iou of every box against ref, writes min(boxes.size(), out.size()) values
+template <typename T, typename S>
+inline void iou(const rect<T, S> & ref, std::span<const std::type_identity_t<rect<T, S>>> boxes, std::span<float> out) noexcept {
+	const auto n = std::min(boxes.size(), out.size());
+	for (std::size_t i = 0; i < n; ++i)
+		out[i] = iou(ref, boxes[i]);
+}
+
 template <typename T, typename S>
 [[nodiscard]] inline rect<T, S> fit_rect(geom::size<S> sz, geom::rect<T, S> bounds) {
+	GEOM_TRACE_OP(fit_rect, bounds, sz);
 	const auto fitted_sz = sz.fitted(bounds.size());
 	const geom::point<T> org{bounds.left() + (T) (bounds.width() - fitted_sz.width) / 2, bounds.top() + (T) (bounds.height() - fitted_sz.height) / 2};
 	return geom::rect<T, S>{org, fitted_sz};
@@ -479,6 +615,7 @@ template <std::unsigned_integral T>
 /// nearest mip level to be minified
 template <std::unsigned_integral T>
 [[nodiscard]] constexpr inline unsigned nearest_mip_level(const size<T> & base_size, const size<T> request_size) {
+	GEOM_TRACE_OP(nearest_mip_level, base_size, request_size);
 	if (request_size.width >= base_size.width || request_size.height >= base_size.height)
 		return 0u;
 	const uint32_t z = std::min(base_size.width / request_size.width,
@@ -494,6 +631,16 @@ using rectu = rect<unsigned int>;
 using rectf = rect<float>;
 using rectn = rect<int, unsigned>; /// normalized rect
 
+/// defined when linking the geom_module target, which holds the explicit instantiations
+#ifdef GEOM_EXTERN_TEMPLATES
+extern template struct point<int>;
+extern template struct point<float>;
+extern template struct size<unsigned>;
+extern template class rect<int>;
+extern template class rect<int, unsigned>;
+extern template class rect<float>;
+#endif
+
 } //ns geom
 
 #endif //GEOM_H
\ No newline at end of file
@@ -0,0 +1,147 @@
+#ifndef GEOM_ANIMATION_H
+#define GEOM_ANIMATION_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_soa.h"
+
+#include <cmath>
+#include <limits>
+
+/// rect animation kernels over rect_soa
+/// each kernel overwrites the current state in place and returns the damage: the union of the old
+/// and new bounds of every rect that changed, nullopt when nothing moved
+
+namespace geom {
+
+/// easing curves mapping t in [0, 1] to [0, 1]
+namespace ease {
+
+[[nodiscard]] inline constexpr float linear(float t) noexcept { return t; }
+[[nodiscard]] inline constexpr float in_quad(float t) noexcept { return t * t; }
+[[nodiscard]] inline constexpr float out_quad(float t) noexcept { return t * (2.f - t); }
+[[nodiscard]] inline constexpr float in_out_cubic(float t) noexcept {
+	const float u = 2.f * t - 2.f;
+	return t < 0.5f ? 4.f * t * t * t : 0.5f * u * u * u + 1.f;
+}
+[[nodiscard]] inline constexpr float smoothstep(float t) noexcept { return t * t * (3.f - 2.f * t); }
+
+} //ns ease
+
+namespace detail {
+
+template <typename T>
+struct damage_bounds {
+	T x1 = std::numeric_limits<T>::max(), y1 = std::numeric_limits<T>::max();
+	T x2 = std::numeric_limits<T>::lowest(), y2 = std::numeric_limits<T>::lowest();
+
+	/// old and new coordinates of one rect, nothing is added when they are equal
+	inline void add(T ox1, T oy1, T ox2, T oy2, T nx1, T ny1, T nx2, T ny2) noexcept {
+		const bool changed = (ox1 != nx1) | (oy1 != ny1) | (ox2 != nx2) | (oy2 != ny2);
+		x1 = changed ? std::min({x1, ox1, nx1}) : x1;
+		y1 = changed ? std::min({y1, oy1, ny1}) : y1;
+		x2 = changed ? std::max({x2, ox2, nx2}) : x2;
+		y2 = changed ? std::max({y2, oy2, ny2}) : y2;
+	}
+
+	template <typename S>
+	[[nodiscard]] inline std::optional<rect<T, S>> result() const {
+		if (x2 < x1)
+			return std::nullopt;
+		return rect<T, S>(x1, y1, x2, y2);
+	}
+};
+
+/// out[i] = f(i) for all four coordinate arrays, tracking the damage
+template <typename T, typename S, typename F>
+inline std::optional<rect<T, S>> update_tracked(rect_soa<T, S> & cur, F && f) {
+	damage_bounds<T> d;
+	T * const x1 = cur.x1.data(), * const y1 = cur.y1.data(), * const x2 = cur.x2.data(), * const y2 = cur.y2.data();
+	for (std::size_t i = 0, n = cur.size(); i < n; ++i) {
+		const auto [nx1, ny1, nx2, ny2] = f(i);
+		d.add(x1[i], y1[i], x2[i], y2[i], nx1, ny1, nx2, ny2);
+		x1[i] = nx1; y1[i] = ny1; x2[i] = nx2; y2[i] = ny2;
+	}
+	return d.template result<S>();
+}
+
+template <typename T, typename S>
+inline void check_sizes(const rect_soa<T, S> & a, const rect_soa<T, S> & b) {
+	if (a.size() != b.size())
+		throw std::invalid_argument("Rect arrays differ in size");
+}
+
+} //ns detail
+
+
+/// cur[i] = from[i] + (to[i] - from[i]) * ease(t[i]), t clamped to [0, 1]
+template <typename F = float (*)(float) noexcept>
+inline std::optional<rectf> lerp(const rectf_soa & from, const rectf_soa & to, std::span<const float> t, rectf_soa & cur, F ease = ease::linear) {
+	detail::check_sizes(from, to);
+	detail::check_sizes(from, cur);
+	if (t.size() != from.size())
+		throw std::invalid_argument("Progress count differs from the rect count");
+	return detail::update_tracked(cur, [&](std::size_t i) {
+		const float e = ease(std::clamp(t[i], 0.f, 1.f));
+		return std::array<float, 4>{ from.x1[i] + (to.x1[i] - from.x1[i]) * e, from.y1[i] + (to.y1[i] - from.y1[i]) * e,
+			from.x2[i] + (to.x2[i] - from.x2[i]) * e, from.y2[i] + (to.y2[i] - from.y2[i]) * e };
+	});
+}
+
+/// keyframes shared by all rects: frames[k] is the state at times[k], times ascending
+/// time outside the range holds the first or last frame, ease applies within each segment
+template <typename F = float (*)(float) noexcept>
+inline std::optional<rectf> sample_keyframes(std::span<const rectf_soa> frames, std::span<const float> times, float time, rectf_soa & cur, F ease = ease::linear) {
+	if (frames.empty() || frames.size() != times.size())
+		throw std::invalid_argument("Keyframe and time counts must match and be non-zero");
+	for (const auto & f : frames)
+		detail::check_sizes(f, cur);
+	const auto k = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+	const auto & a = frames[k == 0 ? 0 : k - 1];
+	const auto & b = frames[k == frames.size() ? k - 1 : k];
+	const float len = k == 0 || k == frames.size() ? 0.f : times[k] - times[k - 1];
+	const float e = len > 0.f ? ease(std::clamp((time - times[k - 1]) / len, 0.f, 1.f)) : 0.f;
+	return detail::update_tracked(cur, [&](std::size_t i) {
+		return std::array<float, 4>{ a.x1[i] + (b.x1[i] - a.x1[i]) * e, a.y1[i] + (b.y1[i] - a.y1[i]) * e,
+			a.x2[i] + (b.x2[i] - a.x2[i]) * e, a.y2[i] + (b.y2[i] - a.y2[i]) * e };
+	});
+}
+
+/// critically damped spring towards target, integrated exactly so any dt is stable
+/// omega is the angular frequency (higher is stiffer), vel holds the per coordinate velocities
+/// coordinates within epsilon of the target with a velocity below epsilon snap to it and stop
+inline std::optional<rectf> spring_step(rectf_soa & cur, rectf_soa & vel, const rectf_soa & target, float omega, float dt, float epsilon = 1e-3f) {
+	detail::check_sizes(cur, vel);
+	detail::check_sizes(cur, target);
+	const float decay = std::exp(-omega * dt);
+	const auto step = [&](float x, float & v, float goal) {
+		const float d = x - goal;
+		const float tmp = (v + omega * d) * dt;
+		const float nv = (v - omega * tmp) * decay;
+		const float nd = (d + tmp) * decay;
+		const bool rest = std::abs(nd) < epsilon && std::abs(nv) < epsilon;
+		v = rest ? 0.f : nv;
+		return rest ? goal : goal + nd;
+	};
+	return detail::update_tracked(cur, [&](std::size_t i) {
+		return std::array<float, 4>{ step(cur.x1[i], vel.x1[i], target.x1[i]), step(cur.y1[i], vel.y1[i], target.y1[i]),
+			step(cur.x2[i], vel.x2[i], target.x2[i]), step(cur.y2[i], vel.y2[i], target.y2[i]) };
+	});
+}
+
+/// pixel snapping by rounding every edge (not origin and size), rects sharing an edge keep sharing it
+/// the previous contents of out are the old state for the damage, out is resized (with zero rects) when needed
+inline std::optional<recti> snap(const rectf_soa & in, recti_soa & out) {
+	if (out.size() != in.size())
+		out.resize(in.size());
+	const auto r = [](float v) { return static_cast<int>(std::floor(v + 0.5f)); };
+	return detail::update_tracked(out, [&](std::size_t i) {
+		return std::array<int, 4>{ r(in.x1[i]), r(in.y1[i]), r(in.x2[i]), r(in.y2[i]) };
+	});
+}
+
+} //ns geom
+
+#endif //GEOM_ANIMATION_H
@@ -0,0 +1,220 @@
+#ifndef GEOM_BEZIER_H
+#define GEOM_BEZIER_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_simd.h"
+#include "geom_soa.h"
+
+#include <cmath>
+#include <limits>
+
+/// tight bounds of quadratic and cubic Bézier curves from the roots of their derivatives
+/// control point bounds overestimate, these are exact up to float rounding
+
+namespace geom {
+
+struct quad_bezier {
+	pointf p0, p1, p2;
+};
+
+struct cubic_bezier {
+	pointf p0, p1, p2, p3;
+};
+
+/// curves stored as coordinate arrays for the batch kernels
+struct quad_bezier_soa {
+	std::vector<float> x0, y0, x1, y1, x2, y2;
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return x0.size(); }
+	inline void reserve(std::size_t n) { for (auto * v : {&x0, &y0, &x1, &y1, &x2, &y2}) v->reserve(n); }
+	inline void clear() noexcept { for (auto * v : {&x0, &y0, &x1, &y1, &x2, &y2}) v->clear(); }
+	inline void push_back(const quad_bezier & c) {
+		x0.push_back(c.p0.x); y0.push_back(c.p0.y);
+		x1.push_back(c.p1.x); y1.push_back(c.p1.y);
+		x2.push_back(c.p2.x); y2.push_back(c.p2.y);
+	}
+	[[nodiscard]] inline quad_bezier operator[](std::size_t i) const noexcept { return {{x0[i], y0[i]}, {x1[i], y1[i]}, {x2[i], y2[i]}}; }
+};
+
+struct cubic_bezier_soa {
+	std::vector<float> x0, y0, x1, y1, x2, y2, x3, y3;
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return x0.size(); }
+	inline void reserve(std::size_t n) { for (auto * v : {&x0, &y0, &x1, &y1, &x2, &y2, &x3, &y3}) v->reserve(n); }
+	inline void clear() noexcept { for (auto * v : {&x0, &y0, &x1, &y1, &x2, &y2, &x3, &y3}) v->clear(); }
+	inline void push_back(const cubic_bezier & c) {
+		x0.push_back(c.p0.x); y0.push_back(c.p0.y);
+		x1.push_back(c.p1.x); y1.push_back(c.p1.y);
+		x2.push_back(c.p2.x); y2.push_back(c.p2.y);
+		x3.push_back(c.p3.x); y3.push_back(c.p3.y);
+	}
+	[[nodiscard]] inline cubic_bezier operator[](std::size_t i) const noexcept { return {{x0[i], y0[i]}, {x1[i], y1[i]}, {x2[i], y2[i]}, {x3[i], y3[i]}}; }
+};
+
+namespace detail {
+
+/// extent of one coordinate of a quadratic curve
+[[nodiscard]] inline constexpr std::pair<float, float> quad_extent(float a, float b, float c) noexcept {
+	float lo = std::min(a, c), hi = std::max(a, c);
+	/// B'(t) = 2((1 - t)(b - a) + t(c - b)), one root
+	const float d0 = b - a, den = d0 - (c - b);
+	if (den != 0.f) {
+		const float t = d0 / den;
+		if (t > 0.f && t < 1.f) {
+			const float u = 1.f - t;
+			const float v = u * u * a + 2.f * u * t * b + t * t * c;
+			lo = std::min(lo, v);
+			hi = std::max(hi, v);
+		}
+	}
+	return {lo, hi};
+}
+
+[[nodiscard]] inline constexpr float cubic_at(float a, float b, float c, float d, float t) noexcept {
+	const float u = 1.f - t;
+	return u * u * u * a + 3.f * u * u * t * b + 3.f * u * t * t * c + t * t * t * d;
+}
+
+/// extent of one coordinate of a cubic curve
+[[nodiscard]] inline std::pair<float, float> cubic_extent(float a, float b, float c, float d) noexcept {
+	float lo = std::min(a, d), hi = std::max(a, d);
+	const auto add = [&](float t) {
+		if (t > 0.f && t < 1.f) {
+			const float v = cubic_at(a, b, c, d, t);
+			lo = std::min(lo, v);
+			hi = std::max(hi, v);
+		}
+	};
+	/// B'(t) / 3 = A t^2 + B t + C, roots as q / A and C / q (no cancellation, A -> 0 leaves the linear root C / q)
+	/// a negative discriminant from rounding evaluates the double root, a point on the curve never widens the bounds
+	const float d0 = b - a, d1 = c - b, d2 = d - c;
+	const float qa = d0 - 2.f * d1 + d2, qb = 2.f * (d1 - d0), qc = d0;
+	const float s = std::sqrt(std::max(qb * qb - 4.f * qa * qc, 0.f));
+	const float q = -0.5f * (qb + std::copysign(s, qb));
+	if (qa != 0.f)
+		add(q / qa);
+	if (q != 0.f)
+		add(qc / q);
+	return {lo, hi};
+}
+
+/// extent of one coordinate of 4 cubics, branchless: every candidate t is clamped to [0, 1]
+/// and evaluated, a point on the curve never widens the exact bounds
+inline void cubic_extent(simd::vec4<float> a, simd::vec4<float> b, simd::vec4<float> c, simd::vec4<float> d,
+	simd::vec4<float> & lo, simd::vec4<float> & hi) noexcept
+{
+	using vec = simd::vec4<float>;
+	const vec zero = vec::splat(0.f), one = vec::splat(1.f), two = vec::splat(2.f), three = vec::splat(3.f);
+	const vec tiny = vec::splat(std::numeric_limits<float>::min());
+	const auto at = [&](vec t) {
+		t = min(max(t, zero), one);
+		const vec u = one - t;
+		return u * u * u * a + three * u * u * t * b + three * u * t * t * c + t * t * t * d;
+	};
+	const vec d0 = b - a, d1 = c - b, d2 = d - c;
+	const vec qa = d0 - two * d1 + d2, qb = two * (d1 - d0), qc = d0;
+	/// same roots as the scalar version, zero denominators are replaced to keep NaN out,
+	/// the resulting t is meaningless but harmless
+	const vec s = sqrt(max(qb * qb - vec::splat(4.f) * qa * qc, zero));
+	const vec q = vec::splat(-0.5f) * (qb + select_lt(qb, zero, zero - s, s));
+	const vec t1 = at(q / select_lt(abs(qa), tiny, one, qa)), t2 = at(qc / select_lt(abs(q), tiny, one, q));
+	lo = min(min(a, d), min(t1, t2));
+	hi = max(max(a, d), max(t1, t2));
+}
+
+inline void quad_extent(simd::vec4<float> a, simd::vec4<float> b, simd::vec4<float> c,
+	simd::vec4<float> & lo, simd::vec4<float> & hi) noexcept
+{
+	using vec = simd::vec4<float>;
+	const vec zero = vec::splat(0.f), one = vec::splat(1.f), two = vec::splat(2.f), tiny = vec::splat(std::numeric_limits<float>::min());
+	const vec d0 = b - a, den = d0 - (c - b);
+	const vec t = min(max(d0 / select_lt(abs(den), tiny, one, den), zero), one);
+	const vec u = one - t;
+	const vec v = u * u * a + two * u * t * b + t * t * c;
+	lo = min(min(a, c), v);
+	hi = max(max(a, c), v);
+}
+
+} //ns detail
+
+/// exact bounds, expanded by half the stroke width (enough for round and butt caps and joins)
+[[nodiscard]] inline constexpr rectf bounds(const quad_bezier & c, float stroke_width = 0.f) noexcept {
+	const auto [x1, x2] = detail::quad_extent(c.p0.x, c.p1.x, c.p2.x);
+	const auto [y1, y2] = detail::quad_extent(c.p0.y, c.p1.y, c.p2.y);
+	return rectf(x1, y1, x2, y2).expanded(stroke_width * 0.5f);
+}
+
+[[nodiscard]] inline rectf bounds(const cubic_bezier & c, float stroke_width = 0.f) noexcept {
+	const auto [x1, x2] = detail::cubic_extent(c.p0.x, c.p1.x, c.p2.x, c.p3.x);
+	const auto [y1, y2] = detail::cubic_extent(c.p0.y, c.p1.y, c.p2.y, c.p3.y);
+	return rectf(x1, y1, x2, y2).expanded(stroke_width * 0.5f);
+}
+
+/// batch bounds of all curves into out (resized), 4 curves per step
+inline void bounds(const cubic_bezier_soa & c, rectf_soa & out, float stroke_width = 0.f) {
+	using vec = simd::vec4<float>;
+	const std::size_t n = c.size();
+	out.resize(n);
+	const vec h = vec::splat(stroke_width * 0.5f);
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vec lo, hi;
+		detail::cubic_extent(vec::load(&c.x0[i]), vec::load(&c.x1[i]), vec::load(&c.x2[i]), vec::load(&c.x3[i]), lo, hi);
+		(lo - h).store(&out.x1[i]);
+		(hi + h).store(&out.x2[i]);
+		detail::cubic_extent(vec::load(&c.y0[i]), vec::load(&c.y1[i]), vec::load(&c.y2[i]), vec::load(&c.y3[i]), lo, hi);
+		(lo - h).store(&out.y1[i]);
+		(hi + h).store(&out.y2[i]);
+	}
+	for (; i < n; ++i)
+		out.set(i, bounds(c[i], stroke_width));
+}
+
+inline void bounds(const quad_bezier_soa & c, rectf_soa & out, float stroke_width = 0.f) {
+	using vec = simd::vec4<float>;
+	const std::size_t n = c.size();
+	out.resize(n);
+	const vec h = vec::splat(stroke_width * 0.5f);
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		vec lo, hi;
+		detail::quad_extent(vec::load(&c.x0[i]), vec::load(&c.x1[i]), vec::load(&c.x2[i]), lo, hi);
+		(lo - h).store(&out.x1[i]);
+		(hi + h).store(&out.x2[i]);
+		detail::quad_extent(vec::load(&c.y0[i]), vec::load(&c.y1[i]), vec::load(&c.y2[i]), lo, hi);
+		(lo - h).store(&out.y1[i]);
+		(hi + h).store(&out.y2[i]);
+	}
+	for (; i < n; ++i)
+		out.set(i, bounds(c[i], stroke_width));
+}
+
+/// union of segment bounds per path, path k owns segments [offsets[k], offsets[k + 1])
+/// zero height or width segments (straight lines) still count, unlike rect::united
+[[nodiscard]] inline std::vector<rectf> path_bounds(const rectf_soa & segments, std::span<const std::size_t> offsets) {
+	std::vector<rectf> paths;
+	if (offsets.empty())
+		return paths;
+	paths.reserve(offsets.size() - 1);
+	for (std::size_t k = 0; k + 1 < offsets.size(); ++k) {
+		if (offsets[k] > offsets[k + 1] || offsets[k + 1] > segments.size())
+			throw std::out_of_range("Path offsets are not ascending or exceed the segment count");
+		float x1 = std::numeric_limits<float>::max(), y1 = x1;
+		float x2 = std::numeric_limits<float>::lowest(), y2 = x2;
+		for (std::size_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+			x1 = std::min(x1, segments.x1[i]);
+			y1 = std::min(y1, segments.y1[i]);
+			x2 = std::max(x2, segments.x2[i]);
+			y2 = std::max(y2, segments.y2[i]);
+		}
+		paths.push_back(x2 < x1 ? rectf(0.f, 0.f, 0.f, 0.f) : rectf(x1, y1, x2, y2));
+	}
+	return paths;
+}
+
+} //ns geom
+
+#endif //GEOM_BEZIER_H
@@ -0,0 +1,368 @@
+#ifndef GEOM_BVH_H
+#define GEOM_BVH_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_simd.h"
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+/// wide bounding volume hierarchy over rects, every node tests all its children with SIMD compares
+
+namespace geom {
+
+enum class bvh_build {
+	sah,   /// binned surface area heuristic (half perimeter in 2D), slower build, faster queries
+	morton /// splits along Morton codes of the rect centers, fast build
+};
+
+/// static BVH whose nodes hold W (4 or 8) child bounds as coordinate arrays, tested W / 4 vec4 compares at a time
+/// ids are indices into the rect span given to the constructor, rects may move afterwards with update() and refit()
+/// queries run on an explicit stack, f may return false to stop early
+template <typename T, typename S = T, unsigned W = 4>
+class bvh {
+	static_assert(std::is_same_v<T, int> || std::is_same_v<T, float>, "bvh supports int and float coordinates");
+	static_assert(W == 4 || W == 8, "bvh nodes are 4 or 8 wide");
+	using vec = simd::vec4<T>;
+public:
+	using id_type = std::uint32_t;
+
+	explicit bvh(std::span<const std::type_identity_t<rect<T, S>>> rects, bvh_build method = bvh_build::sah, unsigned leaf_size = 4)
+		: leaf_size(std::max(leaf_size, 1u))
+	{
+		if (rects.size() >= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+			throw std::length_error("Too many rects for a bvh");
+		ids.resize(rects.size());
+		std::iota(ids.begin(), ids.end(), id_type{0});
+		if (method == bvh_build::morton)
+			sort_morton(rects);
+		centers.reserve(rects.size());
+		for (const id_type id : ids)
+			centers.push_back(center2(rects[id]));
+		if (!ids.empty()) {
+			build_ctx ctx{rects, method};
+			build_node(ctx, 0, static_cast<std::uint32_t>(ids.size()), 1);
+		}
+		prims.reserve(ids.size());
+		slot_of.resize(ids.size());
+		for (std::size_t i = 0; i < ids.size(); ++i) {
+			prims.push_back(rects[ids[i]]);
+			slot_of[ids[i]] = static_cast<std::uint32_t>(i);
+		}
+		centers.clear();
+		centers.shrink_to_fit();
+		codes.clear();
+		codes.shrink_to_fit();
+	}
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return prims.size(); }
+	[[nodiscard]] inline std::size_t node_count() const noexcept { return nodes.size(); }
+	[[nodiscard]] inline unsigned depth() const noexcept { return max_depth; }
+	[[nodiscard]] inline const rect<T, S> & operator[](id_type id) const { return prims[slot_of.at(id)]; }
+
+	/// moves a rect, node bounds are stale until refit()
+	inline void update(id_type id, const rect<T, S> & r) { prims[slot_of.at(id)] = r; }
+
+	/// recomputes all node bounds bottom up, the topology is kept, rebuild when rects moved far
+	void refit() noexcept {
+		/// children are always stored after their parent
+		for (std::size_t n = nodes.size(); n-- > 0;) {
+			node & nd = nodes[n];
+			for (unsigned i = 0; i < W; ++i) {
+				if (nd.child[i] >= 0) {
+					const node & c = nodes[static_cast<std::size_t>(nd.child[i])];
+					set_lane(nd, i, *std::min_element(c.x1, c.x1 + W), *std::min_element(c.y1, c.y1 + W),
+						*std::max_element(c.x2, c.x2 + W), *std::max_element(c.y2, c.y2 + W));
+				} else if (nd.count[i] != 0) {
+					const auto b = bounds_of(static_cast<std::uint32_t>(-1 - nd.child[i]), nd.count[i]);
+					set_lane(nd, i, b[0], b[1], b[2], b[3]);
+				}
+			}
+		}
+	}
+
+	/// rects overlapping q with a positive area, f(id, rect)
+	template <typename F>
+	void query(const rect<T, S> & q, F && f) const {
+		const vec qx1 = vec::splat(q.left()), qy1 = vec::splat(q.top()), qx2 = vec::splat(q.right()), qy2 = vec::splat(q.bottom());
+		traverse([&](const node & nd, unsigned g) {
+			const vec x1 = vec::load(nd.x1 + 4 * g), y1 = vec::load(nd.y1 + 4 * g);
+			const vec x2 = vec::load(nd.x2 + 4 * g), y2 = vec::load(nd.y2 + 4 * g);
+			return cmple(x1, qx2) & cmple(qx1, x2) & cmple(y1, qy2) & cmple(qy1, y2);
+		}, [&](const rect<T, S> & r) {
+			return std::max(r.left(), q.left()) < std::min(r.right(), q.right()) && std::max(r.top(), q.top()) < std::min(r.bottom(), q.bottom());
+		}, f);
+	}
+
+	/// rects containing pt (half-open like rect::contains), f(id, rect)
+	template <typename F>
+	void query(const point<T> & pt, F && f) const {
+		const vec px = vec::splat(pt.x), py = vec::splat(pt.y);
+		traverse([&](const node & nd, unsigned g) {
+			return cmple(vec::load(nd.x1 + 4 * g), px) & cmple(px, vec::load(nd.x2 + 4 * g))
+				& cmple(vec::load(nd.y1 + 4 * g), py) & cmple(py, vec::load(nd.y2 + 4 * g));
+		}, [&](const rect<T, S> & r) { return r.contains(pt); }, f);
+	}
+
+private:
+	template <typename, typename, unsigned, typename>
+	friend class quantized_bvh;
+
+	/// child[i] >= 0 is an inner node, otherwise the leaf holds prims [-1 - child[i], + count[i])
+	/// unused lanes have inverted bounds and never pass the overlap test
+	struct alignas(64) node {
+		T x1[W], y1[W], x2[W], y2[W];
+		std::int32_t child[W];
+		std::uint32_t count[W];
+	};
+
+	struct build_ctx {
+		std::span<const rect<T, S>> rects;
+		bvh_build method;
+	};
+
+	static constexpr std::size_t fixed_stack = 256;
+
+	template <typename Test, typename Prim, typename F>
+	void traverse(Test && test, Prim && prim, F && f) const {
+		if (nodes.empty())
+			return;
+		std::uint32_t fixed[fixed_stack];
+		std::vector<std::uint32_t> heap;
+		std::uint32_t * stack = fixed;
+		if (stack_need > fixed_stack) {
+			heap.resize(stack_need);
+			stack = heap.data();
+		}
+		std::size_t sp = 0;
+		stack[sp++] = 0;
+		while (sp != 0) {
+			const node & nd = nodes[stack[--sp]];
+			unsigned mask = 0;
+			for (unsigned g = 0; g < W / 4; ++g)
+				mask |= test(nd, g) << (4 * g);
+			for (; mask != 0; mask &= mask - 1) {
+				const auto i = static_cast<unsigned>(std::countr_zero(mask));
+				if (nd.child[i] >= 0) {
+					stack[sp++] = static_cast<std::uint32_t>(nd.child[i]);
+					continue;
+				}
+				const auto first = static_cast<std::uint32_t>(-1 - nd.child[i]);
+				for (std::uint32_t k = first; k < first + nd.count[i]; ++k) {
+					if (!prim(prims[k]))
+						continue;
+					if constexpr (std::is_same_v<std::invoke_result_t<F &, id_type, const rect<T, S> &>, bool>) {
+						if (!f(ids[k], prims[k]))
+							return;
+					} else {
+						f(ids[k], prims[k]);
+					}
+				}
+			}
+		}
+	}
+
+	static inline void set_lane(node & nd, unsigned i, T x1, T y1, T x2, T y2) noexcept {
+		nd.x1[i] = x1; nd.y1[i] = y1; nd.x2[i] = x2; nd.y2[i] = y2;
+	}
+
+	/// bounds of prims in build order while building, of prims afterwards
+	[[nodiscard]] std::array<T, 4> bounds_of(std::uint32_t first, std::uint32_t count, std::span<const rect<T, S>> rects = {}) const noexcept {
+		std::array<T, 4> b{std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()};
+		for (std::uint32_t k = first; k < first + count; ++k) {
+			const auto & r = rects.empty() ? prims[k] : rects[ids[k]];
+			b[0] = std::min(b[0], r.left()); b[1] = std::min(b[1], r.top());
+			b[2] = std::max(b[2], r.right()); b[3] = std::max(b[3], r.bottom());
+		}
+		return b;
+	}
+
+	/// doubled center, exact for int
+	[[nodiscard]] static inline std::array<double, 2> center2(const rect<T, S> & r) noexcept {
+		return { static_cast<double>(r.left()) + static_cast<double>(r.right()), static_cast<double>(r.top()) + static_cast<double>(r.bottom()) };
+	}
+
+	std::uint32_t build_node(const build_ctx & ctx, std::uint32_t first, std::uint32_t count, unsigned depth) {
+		const auto index = static_cast<std::uint32_t>(nodes.size());
+		nodes.emplace_back();
+		max_depth = std::max(max_depth, depth);
+		std::array<std::pair<std::uint32_t, std::uint32_t>, W> parts;
+		parts[0] = {first, count};
+		unsigned n = 1;
+		while (n < W) {
+			unsigned best = W;
+			for (unsigned i = 0; i < n; ++i) {
+				if (parts[i].second > leaf_size && (best == W || parts[i].second > parts[best].second))
+					best = i;
+			}
+			if (best == W)
+				break;
+			const auto [f, c] = parts[best];
+			const auto mid = split(ctx, f, c);
+			parts[best] = {f, mid - f};
+			parts[n++] = {mid, f + c - mid};
+		}
+		/// children pushed by a node wait on the stack while one of them descends
+		stack_need = std::max<std::size_t>(stack_need, static_cast<std::size_t>(depth) * (W - 1) + 1);
+		for (unsigned i = 0; i < W; ++i) {
+			if (i >= n) {
+				set_lane(nodes[index], i, std::numeric_limits<T>::max(), std::numeric_limits<T>::max(),
+					std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest());
+				nodes[index].child[i] = -1;
+				nodes[index].count[i] = 0;
+				continue;
+			}
+			const auto [f, c] = parts[i];
+			const auto b = bounds_of(f, c, ctx.rects);
+			std::int32_t child;
+			std::uint32_t leaf_count = 0;
+			if (c <= leaf_size) {
+				child = -1 - static_cast<std::int32_t>(f);
+				leaf_count = c;
+			} else {
+				child = static_cast<std::int32_t>(build_node(ctx, f, c, depth + 1));
+			}
+			node & nd = nodes[index]; /// build_node may have reallocated
+			set_lane(nd, i, b[0], b[1], b[2], b[3]);
+			nd.child[i] = child;
+			nd.count[i] = leaf_count;
+		}
+		return index;
+	}
+
+	/// partitions [first, first + count) in two non-empty parts, returns the start of the second
+	std::uint32_t split(const build_ctx & ctx, std::uint32_t first, std::uint32_t count) {
+		const std::uint32_t end = first + count, middle = first + count / 2;
+		if (ctx.method == bvh_build::morton) {
+			/// highest bit differing over the sorted range, the second part starts where it is set
+			const std::uint32_t diff = codes[first] ^ codes[end - 1];
+			if (diff == 0)
+				return middle;
+			const std::uint32_t bit = std::uint32_t{1} << (31 - std::countl_zero(diff));
+			const auto it = std::partition_point(codes.begin() + first, codes.begin() + end, [bit](std::uint32_t c) { return (c & bit) == 0; });
+			return static_cast<std::uint32_t>(it - codes.begin());
+		}
+		double lo[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+		double hi[2] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+		for (std::uint32_t k = first; k < end; ++k) {
+			for (int a = 0; a < 2; ++a) {
+				lo[a] = std::min(lo[a], centers[k][a]);
+				hi[a] = std::max(hi[a], centers[k][a]);
+			}
+		}
+		const int axis = hi[0] - lo[0] >= hi[1] - lo[1] ? 0 : 1;
+		if (!(hi[axis] > lo[axis]))
+			return split_middle(first, count);
+		constexpr int bins = 16;
+		const double scale = bins / (hi[axis] - lo[axis]) * (1.0 - 1e-9);
+		const auto bin_of = [&](std::uint32_t k) { return std::min(bins - 1, static_cast<int>((centers[k][axis] - lo[axis]) * scale)); };
+		struct bin { std::array<double, 4> b{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+			std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()}; std::uint32_t n = 0; };
+		std::array<bin, bins> bs;
+		const auto grow = [](std::array<double, 4> & b, const std::array<double, 4> & r) {
+			b[0] = std::min(b[0], r[0]); b[1] = std::min(b[1], r[1]); b[2] = std::max(b[2], r[2]); b[3] = std::max(b[3], r[3]);
+		};
+		const auto half_perimeter = [](const std::array<double, 4> & b) { return (b[2] - b[0]) + (b[3] - b[1]); };
+		for (std::uint32_t k = first; k < end; ++k) {
+			const auto & r = ctx.rects[ids[k]];
+			auto & b = bs[static_cast<std::size_t>(bin_of(k))];
+			grow(b.b, {static_cast<double>(r.left()), static_cast<double>(r.top()), static_cast<double>(r.right()), static_cast<double>(r.bottom())});
+			++b.n;
+		}
+		/// sweep from the right for the suffix costs, then from the left
+		std::array<double, bins> right_cost{};
+		bin acc;
+		for (int i = bins - 1; i > 0; --i) {
+			grow(acc.b, bs[static_cast<std::size_t>(i)].b);
+			acc.n += bs[static_cast<std::size_t>(i)].n;
+			right_cost[static_cast<std::size_t>(i)] = acc.n ? half_perimeter(acc.b) * acc.n : 0.0;
+		}
+		acc = {};
+		double best_cost = std::numeric_limits<double>::max();
+		int best = -1;
+		for (int i = 0; i + 1 < bins; ++i) {
+			grow(acc.b, bs[static_cast<std::size_t>(i)].b);
+			acc.n += bs[static_cast<std::size_t>(i)].n;
+			if (acc.n == 0 || acc.n == count)
+				continue;
+			const double cost = half_perimeter(acc.b) * acc.n + right_cost[static_cast<std::size_t>(i + 1)];
+			if (cost < best_cost) {
+				best_cost = cost;
+				best = i;
+			}
+		}
+		if (best < 0)
+			return split_middle(first, count);
+		std::uint32_t mid = first;
+		for (std::uint32_t k = first; k < end; ++k) {
+			if (bin_of(k) <= best) {
+				std::swap(ids[k], ids[mid]);
+				std::swap(centers[k], centers[mid]);
+				++mid;
+			}
+		}
+		return mid;
+	}
+
+	std::uint32_t split_middle(std::uint32_t first, std::uint32_t count) noexcept { return first + count / 2; }
+
+	/// orders ids by the Morton code of the rect centers quantized to 16 bits per axis
+	void sort_morton(std::span<const rect<T, S>> rects) {
+		double lo[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+		double hi[2] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+		for (const auto & r : rects) {
+			const auto c = center2(r);
+			for (int a = 0; a < 2; ++a) {
+				lo[a] = std::min(lo[a], c[a]);
+				hi[a] = std::max(hi[a], c[a]);
+			}
+		}
+		const auto spread = [](std::uint32_t v) {
+			v &= 0xffffu;
+			v = (v | (v << 8)) & 0x00ff00ffu;
+			v = (v | (v << 4)) & 0x0f0f0f0fu;
+			v = (v | (v << 2)) & 0x33333333u;
+			return (v | (v << 1)) & 0x55555555u;
+		};
+		const auto quantize = [&](double v, int a) {
+			return hi[a] > lo[a] ? static_cast<std::uint32_t>((v - lo[a]) / (hi[a] - lo[a]) * 65535.0) : 0u;
+		};
+		std::vector<std::pair<std::uint32_t, id_type>> keyed;
+		keyed.reserve(rects.size());
+		for (const id_type id : ids) {
+			const auto c = center2(rects[id]);
+			keyed.emplace_back(spread(quantize(c[0], 0)) | (spread(quantize(c[1], 1)) << 1), id);
+		}
+		std::sort(keyed.begin(), keyed.end());
+		codes.resize(keyed.size());
+		for (std::size_t i = 0; i < keyed.size(); ++i) {
+			codes[i] = keyed[i].first;
+			ids[i] = keyed[i].second;
+		}
+	}
+
+	unsigned leaf_size;
+	unsigned max_depth = 0;
+	std::size_t stack_need = 1;
+	std::vector<node> nodes;
+	std::vector<id_type> ids; /// prim slot -> id
+	std::vector<rect<T, S>> prims; /// rects in leaf order
+	std::vector<std::uint32_t> slot_of; /// id -> prim slot
+	std::vector<std::array<double, 2>> centers; /// build only, doubled centers in slot order
+	std::vector<std::uint32_t> codes; /// build only, Morton codes in slot order
+};
+
+template <typename T, typename S = T>
+using bvh4 = bvh<T, S, 4>;
+template <typename T, typename S = T>
+using bvh8 = bvh<T, S, 8>;
+
+} //ns geom
+
+#endif //GEOM_BVH_H
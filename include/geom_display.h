@@ -0,0 +1,206 @@
+#ifndef GEOM_DISPLAY_H
+#define GEOM_DISPLAY_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <limits>
+#include <vector>
+
+/// portable monitor lookup (MonitorFromPoint / MonitorFromRect) and window placement
+
+namespace geom {
+
+struct monitor {
+	recti bounds;
+	recti work_area; /// bounds minus task bars and docks
+};
+
+/// what a query returns when no monitor contains or overlaps the argument
+enum class monitor_fallback { none, nearest, primary };
+
+/// monitor rects of a desktop, indexed for repeated lookups
+/// containing-point queries use a grid of the distinct monitor edges (two binary searches),
+/// overlap and nearest queries scan the few monitors, and on layouts without overlapping monitors both kinds keep the last answer
+/// so a window moving within one monitor is answered in O(1)
+/// queries update the cache, use one instance per thread
+class display_layout {
+public:
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	display_layout() = default;
+	explicit display_layout(std::vector<monitor> monitors, std::size_t primary = 0) { set_monitors(std::move(monitors), primary); }
+
+	void set_monitors(std::vector<monitor> monitors, std::size_t primary = 0) {
+		if (!monitors.empty() && primary >= monitors.size())
+			throw std::out_of_range("Primary monitor index out of range");
+		mons = std::move(monitors);
+		prim = mons.empty() ? npos : primary;
+		build();
+	}
+
+#ifdef _WIN32
+	/// monitors of the current desktop in EnumDisplayMonitors order
+	[[nodiscard]] static display_layout from_system() {
+		struct enum_state { std::vector<monitor> mons; std::size_t primary = 0; } st;
+		::EnumDisplayMonitors(nullptr, nullptr, [](HMONITOR hm, HDC, LPRECT, LPARAM lp) -> BOOL {
+			auto & st = *reinterpret_cast<enum_state *>(lp);
+			MONITORINFO mi{};
+			mi.cbSize = sizeof(mi);
+			if (::GetMonitorInfo(hm, &mi)) {
+				if (mi.dwFlags & MONITORINFOF_PRIMARY)
+					st.primary = st.mons.size();
+				st.mons.push_back(monitor{recti(mi.rcMonitor), recti(mi.rcWork)});
+			}
+			return TRUE;
+		}, reinterpret_cast<LPARAM>(&st));
+		return display_layout(std::move(st.mons), st.primary);
+	}
+#endif
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return mons.size(); }
+	[[nodiscard]] inline bool empty() const noexcept { return mons.empty(); }
+	[[nodiscard]] inline std::size_t primary() const noexcept { return prim; }
+	[[nodiscard]] inline const monitor & operator[](std::size_t i) const noexcept { return mons[i]; }
+	[[nodiscard]] inline std::span<const monitor> monitors() const noexcept { return mons; }
+
+	/// lowest index monitor whose bounds contain pt, npos when none does
+	[[nodiscard]] std::size_t containing(const pointi & pt) const noexcept {
+		/// with overlapping monitors a lower index one may contain pt as well
+		if (disjoint && last_point < mons.size() && mons[last_point].bounds.contains(pt))
+			return last_point;
+		const auto ix = cell_index(xs, pt.x), iy = cell_index(ys, pt.y);
+		if (ix == npos || iy == npos)
+			return npos;
+		const auto m = cells[iy * (xs.size() - 1) + ix];
+		if (m != npos)
+			last_point = m;
+		return m;
+	}
+
+	[[nodiscard]] std::size_t from_point(const pointi & pt, monitor_fallback fb = monitor_fallback::nearest) const noexcept {
+		if (const auto m = containing(pt); m != npos)
+			return m;
+		if (fb == monitor_fallback::primary)
+			return prim;
+		if (fb == monitor_fallback::none || mons.empty())
+			return npos;
+		return nearest(pt.x, pt.y, pt.x, pt.y);
+	}
+
+	/// monitor with the largest overlap (lowest index on ties), like MonitorFromRect
+	[[nodiscard]] std::size_t from_rect(const recti & r, monitor_fallback fb = monitor_fallback::nearest) const noexcept {
+		/// on a layout without overlapping monitors a rect inside one monitor overlaps only that one
+		if (disjoint && last_rect < mons.size() && mons[last_rect].bounds.contains(r) && !r.empty())
+			return last_rect;
+		std::uint64_t best_area = 0;
+		std::size_t best = npos;
+		for (std::size_t i = 0; i < mons.size(); ++i) {
+			const auto a = intersection_area(mons[i].bounds, r);
+			best = a > best_area ? i : best;
+			best_area = a > best_area ? a : best_area;
+		}
+		if (best != npos)
+			return last_rect = best;
+		if (fb == monitor_fallback::primary)
+			return prim;
+		if (fb == monitor_fallback::none || mons.empty())
+			return npos;
+		return nearest(r.left(), r.top(), r.right() - 1, r.bottom() - 1);
+	}
+
+	/// pt moved onto the work area of its monitor (nearest one when outside all), points inside one stay put
+	[[nodiscard]] pointi clamp(const pointi & pt) const {
+		const auto m = from_point(pt);
+		if (m == npos)
+			throw std::out_of_range("Display layout has no monitors");
+		return geom::clamp(pt, mons[m].work_area);
+	}
+
+	/// window moved by the least amount to lie inside the work area of the monitor it overlaps most
+	/// a window larger than the work area keeps its top left corner (title bar) visible,
+	/// or is shrunk to the work area with shrink set
+	[[nodiscard]] recti move_onto(const recti & window, bool shrink = false) const {
+		const auto m = from_rect(window);
+		if (m == npos)
+			throw std::out_of_range("Display layout has no monitors");
+		const auto & wa = mons[m].work_area;
+		const auto axis = [shrink](int lo, int hi, int wlo, int whi) {
+			if (shrink && hi - lo > whi - wlo)
+				return std::pair{wlo, whi};
+			const int d = hi > whi ? whi - hi : 0;
+			const int nlo = std::max(lo + d, wlo);
+			return std::pair{nlo, nlo + (hi - lo)};
+		};
+		const auto [x1, x2] = axis(window.left(), window.right(), wa.left(), wa.right());
+		const auto [y1, y2] = axis(window.top(), window.bottom(), wa.top(), wa.bottom());
+		return recti(x1, y1, x2, y2);
+	}
+
+private:
+	void build() {
+		xs.clear();
+		ys.clear();
+		for (const auto & m : mons) {
+			xs.insert(xs.end(), {m.bounds.left(), m.bounds.right()});
+			ys.insert(ys.end(), {m.bounds.top(), m.bounds.bottom()});
+		}
+		for (auto * v : {&xs, &ys}) {
+			std::sort(v->begin(), v->end());
+			v->erase(std::unique(v->begin(), v->end()), v->end());
+		}
+		const std::size_t nx = xs.empty() ? 0 : xs.size() - 1, ny = ys.empty() ? 0 : ys.size() - 1;
+		cells.assign(nx * ny, npos);
+		disjoint = true;
+		/// highest index first so the lowest one wins on overlapping (mirrored) monitors
+		for (std::size_t i = mons.size(); i-- > 0;) {
+			const auto & b = mons[i].bounds;
+			const auto x1 = cell_index(xs, b.left()), x2 = cell_index(xs, b.right());
+			const auto y1 = cell_index(ys, b.top()), y2 = cell_index(ys, b.bottom());
+			if (x1 == npos || y1 == npos)
+				continue; /// empty monitor rect
+			for (std::size_t y = y1; y < (y2 == npos ? ny : y2); ++y) {
+				for (std::size_t x = x1; x < (x2 == npos ? nx : x2); ++x) {
+					disjoint = disjoint && cells[y * nx + x] == npos;
+					cells[y * nx + x] = i;
+				}
+			}
+		}
+		last_point = last_rect = npos;
+	}
+
+	/// cell of the sorted distinct edges holding v, npos outside
+	[[nodiscard]] static inline std::size_t cell_index(const std::vector<int> & edges, int v) noexcept {
+		const auto it = std::upper_bound(edges.begin(), edges.end(), v);
+		if (it == edges.begin() || it == edges.end())
+			return npos;
+		return static_cast<std::size_t>(it - edges.begin()) - 1;
+	}
+
+	/// monitor with the smallest gap to the inclusive box [x1, x2] x [y1, y2]
+	[[nodiscard]] std::size_t nearest(int x1, int y1, int x2, int y2) const noexcept {
+		std::uint64_t best_d = std::numeric_limits<std::uint64_t>::max();
+		std::size_t best = 0;
+		for (std::size_t i = 0; i < mons.size(); ++i) {
+			const auto & b = mons[i].bounds;
+			const std::int64_t dx = std::max({std::int64_t{b.left()} - x2, std::int64_t{x1} - (std::int64_t{b.right()} - 1), std::int64_t{0}});
+			const std::int64_t dy = std::max({std::int64_t{b.top()} - y2, std::int64_t{y1} - (std::int64_t{b.bottom()} - 1), std::int64_t{0}});
+			const auto d = static_cast<std::uint64_t>(dx * dx + dy * dy);
+			best = d < best_d ? i : best;
+			best_d = d < best_d ? d : best_d;
+		}
+		return best;
+	}
+
+	std::vector<monitor> mons;
+	std::size_t prim = npos;
+	std::vector<int> xs, ys; /// distinct monitor edges
+	std::vector<std::size_t> cells; /// lowest index monitor covering each grid cell, row major
+	bool disjoint = true;
+	mutable std::size_t last_point = npos, last_rect = npos;
+};
+
+} //ns geom
+
+#endif //GEOM_DISPLAY_H
@@ -0,0 +1,126 @@
+#ifndef GEOM_EXTENT_INDEX_H
+#define GEOM_EXTENT_INDEX_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// prefix sums of variable item extents for virtualized lists
+
+namespace geom {
+
+/// items of variable extent stacked along O (vert: along y, hor: along x)
+/// backed by a Fenwick tree: extent updates, offset and index lookups are O(log n)
+template <orientation O>
+class item_extent_index {
+public:
+	struct index_range {
+		std::size_t first, last; /// half-open
+		[[nodiscard]] inline constexpr bool empty() const noexcept { return first >= last; }
+		[[nodiscard]] inline constexpr std::size_t size() const noexcept { return last > first ? last - first : 0u; }
+	};
+
+	/// org is the top left of the first item, cross_extent is the item size across O
+	item_extent_index(pointi org, unsigned cross_extent) : org(org), cross(cross_extent), tree(1, 0u) {}
+	item_extent_index(pointi org, unsigned cross_extent, std::span<const unsigned> extents)
+		: org(org), cross(cross_extent), ext(extents.begin(), extents.end()), tree(extents.size() + 1, 0u) {
+		/// O(n) build: every node pushes its sum to its parent
+		for (std::size_t i = 1; i < tree.size(); ++i) {
+			tree[i] += ext[i - 1];
+			const std::size_t p = i + (i & (~i + 1));
+			if (p < tree.size())
+				tree[p] += tree[i];
+		}
+	}
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return ext.size(); }
+	[[nodiscard]] inline unsigned extent(std::size_t i) const { return ext.at(i); }
+	[[nodiscard]] inline pointi origin() const noexcept { return org; }
+	inline void set_origin(pointi p) noexcept { org = p; }
+	[[nodiscard]] inline unsigned cross_extent() const noexcept { return cross; }
+	inline void set_cross_extent(unsigned c) noexcept { cross = c; }
+
+	inline void set_extent(std::size_t i, unsigned e) {
+		const unsigned old = ext.at(i);
+		ext[i] = e;
+		/// unsigned wrap-around adds the signed delta
+		const std::uint64_t delta = static_cast<std::uint64_t>(e) - old;
+		for (std::size_t k = i + 1; k < tree.size(); k += k & (~k + 1))
+			tree[k] += delta;
+	}
+
+	inline void push_back(unsigned e) {
+		ext.push_back(e);
+		const std::size_t k = ext.size();
+		/// node k covers items (k - lowbit(k), k]
+		tree.push_back(prefix(k - 1) - prefix(k - (k & (~k + 1))) + e);
+	}
+
+	/// distance from origin to the start of item i, i == size() gives total()
+	[[nodiscard]] inline std::uint64_t offset(std::size_t i) const {
+		if (i > size())
+			throw std::out_of_range("Item index out of range");
+		return prefix(i);
+	}
+	[[nodiscard]] inline std::uint64_t total() const noexcept { return prefix(size()); }
+
+	/// item covering the offset from origin, size() when past the end
+	/// zero extent items are never returned
+	[[nodiscard]] inline std::size_t index_at(std::uint64_t off) const noexcept {
+		std::size_t pos = 0;
+		for (std::size_t step = std::bit_floor(size()); step != 0; step >>= 1) {
+			if (pos + step < tree.size() && tree[pos + step] <= off) {
+				pos += step;
+				off -= tree[pos];
+			}
+		}
+		return pos;
+	}
+
+	/// throws std::out_of_range for i >= size() and when the item does not fit the int coordinate range
+	[[nodiscard]] inline rectn item_rect(std::size_t i) const {
+		const std::uint64_t off = offset(i);
+		const std::int64_t base = O == orientation::vert ? org.y : org.x;
+		if (i >= size() || off + ext[i] > static_cast<std::uint64_t>(std::int64_t{std::numeric_limits<int>::max()} - base))
+			throw std::out_of_range("Item rect outside of the int coordinate range");
+		const auto start = static_cast<int>(base + static_cast<std::int64_t>(off));
+		if constexpr (O == orientation::vert)
+			return rectn::from_size(org.x, start, cross, ext[i]);
+		else
+			return rectn::from_size(start, org.y, ext[i], cross);
+	}
+
+	/// items intersecting the viewport along O, the cross axis is not tested
+	/// zero extent items may be included next to them
+	[[nodiscard]] inline index_range visible_range(const rectn & viewport) const noexcept {
+		const auto [lo, hi] = (O == orientation::vert)
+			? std::pair{viewport.top() - org.y, viewport.bottom() - org.y}
+			: std::pair{viewport.left() - org.x, viewport.right() - org.x};
+		if (hi <= 0 || hi <= lo)
+			return {0, 0};
+		const std::size_t first = index_at(static_cast<std::uint64_t>(std::max(lo, 0)));
+		const std::size_t last = std::min(index_at(static_cast<std::uint64_t>(hi - 1)) + 1, size());
+		return {first, std::max(first, last)};
+	}
+
+private:
+	[[nodiscard]] inline std::uint64_t prefix(std::size_t n) const noexcept {
+		std::uint64_t s = 0;
+		for (; n != 0; n &= n - 1)
+			s += tree[n];
+		return s;
+	}
+
+	pointi org;
+	unsigned cross;
+	std::vector<unsigned> ext;
+	std::vector<std::uint64_t> tree; /// 1-based Fenwick tree
+};
+
+} //ns geom
+
+#endif //GEOM_EXTENT_INDEX_H
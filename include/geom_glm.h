@@ -0,0 +1,66 @@
+#ifndef GEOM_GLM_H
+#define GEOM_GLM_H
+
+#ifndef GEOM_INTEROP_H
+#error geom_interop.h must be included first
+#endif
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+/// opt-in glm interop: pointf <-> glm::vec2, rectf <-> glm::vec4 {x1, y1, x2, y2}
+
+namespace geom {
+
+static_assert(sizeof(glm::vec2) == sizeof(pointf) && std::is_trivially_copyable_v<glm::vec2>, "glm::vec2 is not layout compatible with pointf");
+static_assert(sizeof(glm::ivec2) == sizeof(pointi) && std::is_trivially_copyable_v<glm::ivec2>, "glm::ivec2 is not layout compatible with pointi");
+static_assert(sizeof(glm::vec4) == sizeof(rectf) && std::is_trivially_copyable_v<glm::vec4>, "glm::vec4 is not layout compatible with rectf");
+
+[[nodiscard]] inline glm::vec2 to_glm(const pointf & p) noexcept { return std::bit_cast<glm::vec2>(p); }
+[[nodiscard]] inline glm::ivec2 to_glm(const pointi & p) noexcept { return std::bit_cast<glm::ivec2>(p); }
+[[nodiscard]] inline glm::vec2 to_glm(const sizef & s) noexcept { return std::bit_cast<glm::vec2>(s); }
+[[nodiscard]] inline glm::vec4 to_glm(const rectf & r) noexcept { return std::bit_cast<glm::vec4>(r); }
+[[nodiscard]] inline pointf from_glm(const glm::vec2 & v) noexcept { return std::bit_cast<pointf>(v); }
+[[nodiscard]] inline pointi from_glm(const glm::ivec2 & v) noexcept { return std::bit_cast<pointi>(v); }
+[[nodiscard]] inline rectf from_glm(const glm::vec4 & v) noexcept { return rectf(v.x, v.y, v.z, v.w); }
+
+/// the span views below reinterpret arrays in place and need the target type to be no more
+/// aligned than the source, which GLM_FORCE_DEFAULT_ALIGNED_GENTYPES breaks for vec4;
+/// to_glm/from_glm copy and work with any alignment
+
+/// pointf range as glm::vec2
+template <detail::geom_range R>
+	requires std::is_same_v<std::remove_const_t<detail::element_t<R>>, pointf>
+[[nodiscard]] inline auto as_vec2(R && r) noexcept {
+	static_assert(alignof(glm::vec2) <= alignof(detail::element_t<R>), "glm::vec2 is over-aligned, copy with to_glm instead");
+	using V = detail::copy_const_t<detail::element_t<R>, glm::vec2>;
+	return std::span<V>(reinterpret_cast<V *>(std::ranges::data(r)), std::ranges::size(r));
+}
+
+/// rectf range as glm::vec4
+template <detail::geom_range R>
+	requires std::is_same_v<std::remove_const_t<detail::element_t<R>>, rectf>
+[[nodiscard]] inline auto as_vec4(R && r) noexcept {
+	static_assert(alignof(glm::vec4) <= alignof(detail::element_t<R>), "glm::vec4 is over-aligned, copy with to_glm instead");
+	using V = detail::copy_const_t<detail::element_t<R>, glm::vec4>;
+	return std::span<V>(reinterpret_cast<V *>(std::ranges::data(r)), std::ranges::size(r));
+}
+
+static_assert(alignof(pointf) <= alignof(glm::vec2) && alignof(pointi) <= alignof(glm::ivec2) && alignof(rectf) <= alignof(glm::vec4));
+
+[[nodiscard]] inline std::span<pointf> as_points(std::span<glm::vec2> v) noexcept {
+	return { reinterpret_cast<pointf *>(v.data()), v.size() };
+}
+[[nodiscard]] inline std::span<const pointf> as_points(std::span<const glm::vec2> v) noexcept {
+	return { reinterpret_cast<const pointf *>(v.data()), v.size() };
+}
+[[nodiscard]] inline std::span<rectf> as_rects(std::span<glm::vec4> v) noexcept {
+	return { reinterpret_cast<rectf *>(v.data()), v.size() };
+}
+[[nodiscard]] inline std::span<const rectf> as_rects(std::span<const glm::vec4> v) noexcept {
+	return { reinterpret_cast<const rectf *>(v.data()), v.size() };
+}
+
+} //ns geom
+
+#endif //GEOM_GLM_H
@@ -0,0 +1,111 @@
+#ifndef GEOM_GRID_INDEX_H
+#define GEOM_GRID_INDEX_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// uniform grid spatial index over rects with dense ids
+
+namespace geom {
+
+/// each rect is listed in every cell it touches, queries visit the cells of the query rect
+/// ids are dense indices, storage grows to the largest inserted id
+template <typename T, typename S = T>
+class grid_index {
+public:
+	using id_type = std::uint32_t;
+
+	explicit grid_index(T cell_size) : cell(cell_size) {
+		if (!(cell_size > T{0}))
+			throw std::invalid_argument("Grid cell size must be positive");
+	}
+
+	void insert(id_type id, const rect<T, S> & r) {
+		if (id >= bounds.size()) {
+			bounds.resize(id + 1);
+			stamps.resize(id + 1, 0u);
+		}
+		if (bounds[id])
+			throw std::invalid_argument("Duplicate grid index id");
+		bounds[id] = r;
+		for_each_cell(r, [&](std::uint64_t key) { cells[key].push_back(id); });
+		++count;
+	}
+	bool erase(id_type id) {
+		if (id >= bounds.size() || !bounds[id])
+			return false;
+		for_each_cell(*bounds[id], [&](std::uint64_t key) {
+			auto & v = cells[key];
+			const auto it = std::find(v.begin(), v.end(), id);
+			*it = v.back();
+			v.pop_back();
+			if (v.empty())
+				cells.erase(key);
+		});
+		bounds[id].reset();
+		--count;
+		return true;
+	}
+	void update(id_type id, const rect<T, S> & r) {
+		erase(id);
+		insert(id, r);
+	}
+	[[nodiscard]] inline std::size_t size() const noexcept { return count; }
+	[[nodiscard]] inline const std::optional<rect<T, S>> & at(id_type id) const { return bounds.at(id); }
+
+	/// calls f(id, rect) once for every rect sharing a cell with the query, callers test the actual overlap
+	template <typename F>
+	void query(const rect<T, S> & q, F && f) const {
+		if (++stamp == 0u) {
+			std::fill(stamps.begin(), stamps.end(), 0u);
+			stamp = 1u;
+		}
+		for_each_cell(q, [&](std::uint64_t key) {
+			const auto it = cells.find(key);
+			if (it == cells.end())
+				return;
+			for (const id_type id : it->second) {
+				if (stamps[id] == stamp)
+					continue;
+				stamps[id] = stamp;
+				f(id, *bounds[id]);
+			}
+		});
+	}
+
+private:
+	[[nodiscard]] inline std::int32_t cell_of(T v) const noexcept {
+		if constexpr (std::is_floating_point_v<T>) {
+			return static_cast<std::int32_t>(std::floor(v / cell));
+		} else if constexpr (std::is_signed_v<T>) {
+			return static_cast<std::int32_t>(v >= 0 ? v / cell : -((-(v + 1)) / cell) - 1);
+		} else {
+			return static_cast<std::int32_t>(v / cell);
+		}
+	}
+
+	template <typename F>
+	inline void for_each_cell(const rect<T, S> & r, F && f) const {
+		const auto cx1 = cell_of(r.left()), cx2 = cell_of(r.right());
+		const auto cy1 = cell_of(r.top()), cy2 = cell_of(r.bottom());
+		for (auto cy = cy1; cy <= cy2; ++cy)
+			for (auto cx = cx1; cx <= cx2; ++cx)
+				f((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy)) << 32) | static_cast<std::uint32_t>(cx));
+	}
+
+	T cell;
+	std::size_t count = 0;
+	std::vector<std::optional<rect<T, S>>> bounds;
+	std::unordered_map<std::uint64_t, std::vector<id_type>> cells;
+	mutable std::vector<std::uint32_t> stamps; /// visited marks of the current query
+	mutable std::uint32_t stamp = 0;
+};
+
+} //ns geom
+
+#endif //GEOM_GRID_INDEX_H
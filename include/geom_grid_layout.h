@@ -0,0 +1,173 @@
+#ifndef GEOM_GRID_LAYOUT_H
+#define GEOM_GRID_LAYOUT_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+/// css-grid like layout of items with spans into rectn arrays
+
+namespace geom {
+
+class grid_layout {
+public:
+	struct track {
+		enum class kind : std::uint8_t { fixed, fraction, automatic };
+		kind k;
+		unsigned value; /// pixels for fixed, weight for fraction, minimum for automatic
+
+		[[nodiscard]] static constexpr inline track fixed(unsigned px) noexcept { return {kind::fixed, px}; }
+		[[nodiscard]] static constexpr inline track fr(unsigned weight) noexcept { return {kind::fraction, weight}; }
+		/// sized to the largest content of items spanning only this track
+		[[nodiscard]] static constexpr inline track automatic(unsigned min = 0) noexcept { return {kind::automatic, min}; }
+		[[nodiscard]] friend constexpr inline bool operator==(const track &, const track &) = default;
+	};
+
+	struct item {
+		unsigned row, column;
+		unsigned row_span = 1, column_span = 1;
+		sizeu content{0, 0}; /// used by automatic tracks
+	};
+
+	/// throws std::out_of_range when an existing item would end outside the new tracks,
+	/// clear_items() first to shrink the grid under them
+	inline void set_columns(std::vector<track> t) { set_tracks<orientation::hor>(cols, std::move(t)); }
+	inline void set_rows(std::vector<track> t) { set_tracks<orientation::vert>(rows, std::move(t)); }
+	inline void set_gap(unsigned column_gap, unsigned row_gap) noexcept {
+		if (cols.gap != column_gap) { cols.gap = column_gap; cols.content_dirty = true; }
+		if (rows.gap != row_gap) { rows.gap = row_gap; rows.content_dirty = true; }
+	}
+
+	/// returns the index of the item rect in layout() output
+	inline std::size_t add_item(const item & it) {
+		if (it.row_span == 0 || it.column_span == 0
+				|| it.row + it.row_span > rows.tracks.size() || it.column + it.column_span > cols.tracks.size())
+			throw std::out_of_range("Grid item outside of tracks");
+		items.push_back(it);
+		cols.content_dirty = rows.content_dirty = true;
+		return items.size() - 1;
+	}
+	inline void set_item_content(std::size_t i, sizeu content) {
+		auto & it = items.at(i);
+		if (it.content == content)
+			return;
+		it.content = content;
+		cols.content_dirty |= it.column_span == 1 && cols.tracks[it.column].k == track::kind::automatic;
+		rows.content_dirty |= it.row_span == 1 && rows.tracks[it.row].k == track::kind::automatic;
+	}
+	inline void clear_items() noexcept {
+		items.clear();
+		cols.content_dirty = rows.content_dirty = true;
+	}
+	[[nodiscard]] inline std::size_t item_count() const noexcept { return items.size(); }
+
+	/// lays out all items in one pass, track sizes are only recomputed for an axis
+	/// whose tracks, automatic contents or available extent changed
+	std::span<const rectn> layout(const rectn & bounds) {
+		update_axis<orientation::hor>(cols, bounds.width());
+		update_axis<orientation::vert>(rows, bounds.height());
+		rects.resize(items.size(), rectn(0, 0, 0, 0));
+		for (std::size_t i = 0; i < items.size(); ++i) {
+			const auto & it = items[i];
+			const auto x1 = cols.offsets[it.column];
+			const auto x2 = cols.offsets[it.column + it.column_span] - cols.gap;
+			const auto y1 = rows.offsets[it.row];
+			const auto y2 = rows.offsets[it.row + it.row_span] - rows.gap;
+			rects[i] = rectn(bounds.left() + static_cast<int>(x1), bounds.top() + static_cast<int>(y1),
+				bounds.left() + static_cast<int>(x2), bounds.top() + static_cast<int>(y2));
+		}
+		return rects;
+	}
+
+	[[nodiscard]] inline std::span<const unsigned> column_sizes() const noexcept { return cols.sizes; }
+	[[nodiscard]] inline std::span<const unsigned> row_sizes() const noexcept { return rows.sizes; }
+
+private:
+	struct axis {
+		std::vector<track> tracks;
+		std::vector<unsigned> base; /// fixed and automatic sizes, fractions are zero
+		std::vector<unsigned> sizes;
+		std::vector<unsigned> offsets; /// track start, offsets[n] is the end of the last track plus gap
+		unsigned gap = 0;
+		unsigned extent = 0;
+		bool content_dirty = true;
+		bool extent_valid = false;
+	};
+
+	template <orientation O>
+	void set_tracks(axis & a, std::vector<track> t) {
+		if (a.tracks == t)
+			return;
+		for (const auto & it : items) {
+			const auto end = (O == orientation::hor) ? std::size_t{it.column} + it.column_span : std::size_t{it.row} + it.row_span;
+			if (end > t.size())
+				throw std::out_of_range("Grid item outside of tracks");
+		}
+		a.tracks = std::move(t);
+		a.content_dirty = true;
+	}
+
+	template <orientation O>
+	void update_axis(axis & a, unsigned extent) {
+		const std::size_t n = a.tracks.size();
+		if (a.content_dirty) {
+			a.base.assign(n, 0u);
+			for (std::size_t i = 0; i < n; ++i)
+				if (a.tracks[i].k != track::kind::fraction)
+					a.base[i] = a.tracks[i].value;
+			for (const auto & it : items) {
+				const auto [start, span, content] = (O == orientation::hor)
+					? std::tuple{it.column, it.column_span, it.content.width}
+					: std::tuple{it.row, it.row_span, it.content.height};
+				if (span == 1 && a.tracks[start].k == track::kind::automatic)
+					a.base[start] = std::max(a.base[start], content);
+			}
+			a.extent_valid = false;
+			a.content_dirty = false;
+		}
+		if (a.extent_valid && a.extent == extent)
+			return;
+		a.extent = extent;
+		a.extent_valid = true;
+
+		std::uint64_t used = n > 1 ? std::uint64_t{a.gap} * (n - 1) : 0u;
+		std::uint64_t weights = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			used += a.base[i];
+			if (a.tracks[i].k == track::kind::fraction)
+				weights += a.tracks[i].value;
+		}
+		const std::uint64_t free = used < extent ? extent - used : 0u;
+
+		/// cumulative rounding, fractions add up to free exactly
+		a.sizes = a.base;
+		std::uint64_t acc = 0, prev = 0;
+		for (std::size_t i = 0; weights != 0 && i < n; ++i) {
+			if (a.tracks[i].k != track::kind::fraction)
+				continue;
+			acc += a.tracks[i].value;
+			const std::uint64_t cur = free * acc / weights;
+			a.sizes[i] = static_cast<unsigned>(cur - prev);
+			prev = cur;
+		}
+		a.offsets.resize(n + 1);
+		unsigned off = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			a.offsets[i] = off;
+			off += a.sizes[i] + a.gap;
+		}
+		a.offsets[n] = off;
+	}
+
+	axis cols, rows;
+	std::vector<item> items;
+	std::vector<rectn> rects;
+};
+
+} //ns geom
+
+#endif //GEOM_GRID_LAYOUT_H
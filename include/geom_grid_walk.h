@@ -0,0 +1,156 @@
+#ifndef GEOM_GRID_WALK_H
+#define GEOM_GRID_WALK_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+/// cells of a uniform grid crossed by a segment (Amanatides–Woo traversal)
+
+namespace geom {
+
+template <typename T>
+struct segment {
+	point<T> a, b;
+};
+
+namespace detail {
+
+template <typename T>
+[[nodiscard]] inline constexpr int floor_cell(T v, T cell) noexcept {
+	if constexpr (std::is_integral_v<T>) {
+		const auto q = static_cast<std::int64_t>(v) / cell, r = static_cast<std::int64_t>(v) % cell;
+		return static_cast<int>(r < 0 ? q - 1 : q);
+	} else {
+		return static_cast<int>(std::floor(v / cell));
+	}
+}
+
+} //ns detail
+
+/// the cells a segment from a to b passes through, in order from a's cell to b's cell
+/// cell (x, y) covers [origin + x * cell, origin + (x + 1) * cell), cells may be negative
+/// the walk visits exactly 1 + |dx| + |dy| cells (in cells), stepping x first when a grid corner is hit
+/// exactly, integer coordinates are compared exactly, no allocations
+/// coordinates are relative to origin, unsigned types would wrap and are rejected
+template <typename T>
+class grid_walk {
+	static_assert(std::is_signed_v<T>, "grid_walk needs signed coordinates");
+	/// boundary distances are compared cross-multiplied, no division and no infinities
+	using acc = std::conditional_t<std::is_integral_v<T>, std::int64_t, double>;
+public:
+	struct sentinel {};
+
+	class iterator {
+	public:
+		using value_type = pointi;
+		using difference_type = std::ptrdiff_t;
+		using iterator_concept = std::input_iterator_tag;
+
+		iterator() = default;
+		[[nodiscard]] inline const pointi & operator*() const noexcept { return cell; }
+		[[nodiscard]] inline const pointi * operator->() const noexcept { return &cell; }
+		inline iterator & operator++() noexcept {
+			if (remaining == 0) {
+				done = true;
+				return *this;
+			}
+			--remaining;
+			/// next x boundary at t = nx / adx, next y boundary at t = ny / ady
+			if (ny_left == 0 || (nx_left != 0 && nx * ady <= ny * adx)) {
+				cell.x += step_x;
+				nx += cw;
+				--nx_left;
+			} else {
+				cell.y += step_y;
+				ny += ch;
+				--ny_left;
+			}
+			return *this;
+		}
+		inline void operator++(int) noexcept { ++*this; }
+		[[nodiscard]] friend inline bool operator==(const iterator & it, sentinel) noexcept { return it.done; }
+
+		/// cells left after the current one
+		[[nodiscard]] inline std::size_t remaining_cells() const noexcept { return done ? 0 : remaining; }
+
+	private:
+		friend class grid_walk;
+		pointi cell{0, 0};
+		int step_x = 0, step_y = 0;
+		acc nx = 0, ny = 0, cw = 0, ch = 0, adx = 0, ady = 0;
+		std::size_t remaining = 0, nx_left = 0, ny_left = 0;
+		bool done = true;
+	};
+
+	/// throws std::invalid_argument for non-positive cell sizes
+	grid_walk(point<T> origin, size<T> cell, point<T> a, point<T> b) {
+		if (!(cell.width > T{}) || !(cell.height > T{}))
+			throw std::invalid_argument("Grid cell size must be positive");
+		const auto axis = [](T org, T c, T from, T to, int & cell_i, int & step, acc & next, acc & d, std::size_t & count) {
+			const T p = from - org, q = to - org;
+			cell_i = detail::floor_cell(p, c);
+			const int last = detail::floor_cell(q, c);
+			step = last > cell_i ? 1 : (last < cell_i ? -1 : 0);
+			count = static_cast<std::size_t>(last > cell_i ? last - cell_i : cell_i - last);
+			d = q > p ? static_cast<acc>(q) - static_cast<acc>(p) : static_cast<acc>(p) - static_cast<acc>(q);
+			/// distance from p to the first boundary crossed
+			const acc lo = static_cast<acc>(cell_i) * static_cast<acc>(c);
+			next = step >= 0 ? lo + static_cast<acc>(c) - static_cast<acc>(p) : static_cast<acc>(p) - lo;
+		};
+		axis(origin.x, cell.width, a.x, b.x, first.cell.x, first.step_x, first.nx, first.adx, first.nx_left);
+		axis(origin.y, cell.height, a.y, b.y, first.cell.y, first.step_y, first.ny, first.ady, first.ny_left);
+		first.cw = static_cast<acc>(cell.width);
+		first.ch = static_cast<acc>(cell.height);
+		first.remaining = first.nx_left + first.ny_left;
+		first.done = false;
+	}
+
+	[[nodiscard]] inline iterator begin() const noexcept { return first; }
+	[[nodiscard]] inline sentinel end() const noexcept { return {}; }
+	[[nodiscard]] inline std::size_t size() const noexcept { return first.remaining + 1; }
+
+private:
+	iterator first;
+};
+
+
+/// cells crossed by every segment as linear indices y * columns + x of a columns x rows grid,
+/// stored CSR style: segment i owns cells[offsets[i], offsets[i + 1])
+/// cells outside the grid are skipped and a walk stops once it has left the grid (segments are convex),
+/// at most max_cells are emitted per segment
+template <typename T>
+void grid_walk_cells(point<T> origin, size<T> cell, unsigned columns, unsigned rows, std::span<const std::type_identity_t<segment<T>>> segments,
+	std::vector<std::uint32_t> & cells, std::vector<std::size_t> & offsets, std::size_t max_cells = std::numeric_limits<std::size_t>::max())
+{
+	cells.clear();
+	offsets.clear();
+	offsets.reserve(segments.size() + 1);
+	offsets.push_back(0);
+	for (const auto & s : segments) {
+		std::size_t n = 0;
+		bool entered = false;
+		for (const auto & c : grid_walk<T>(origin, cell, s.a, s.b)) {
+			const bool inside = c.x >= 0 && c.y >= 0 && static_cast<unsigned>(c.x) < columns && static_cast<unsigned>(c.y) < rows;
+			if (!inside) {
+				if (entered)
+					break;
+				continue;
+			}
+			entered = true;
+			cells.push_back(static_cast<std::uint32_t>(c.y) * columns + static_cast<std::uint32_t>(c.x));
+			if (++n == max_cells)
+				break;
+		}
+		offsets.push_back(cells.size());
+	}
+}
+
+} //ns geom
+
+#endif //GEOM_GRID_WALK_H
@@ -0,0 +1,116 @@
+#ifndef GEOM_INTEROP_H
+#define GEOM_INTEROP_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <array>
+#include <cstddef> /// for offsetof
+#include <ranges>
+
+/// zero-copy reinterpretation of point, size and rect arrays as plain scalar arrays
+/// layout: point {x, y}, size {width, height}, rect {x1, y1, x2, y2}, no padding
+
+namespace geom {
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool point_layout = std::is_standard_layout_v<point<T>> && std::is_trivially_copyable_v<point<T>>
+	&& sizeof(point<T>) == 2 * sizeof(T) && offsetof(point<T>, x) == 0 && offsetof(point<T>, y) == sizeof(T);
+
+template <typename T>
+inline constexpr bool size_layout = std::is_standard_layout_v<size<T>> && std::is_trivially_copyable_v<size<T>>
+	&& sizeof(size<T>) == 2 * sizeof(T) && offsetof(size<T>, width) == 0 && offsetof(size<T>, height) == sizeof(T);
+
+/// rect members are private, the field order is checked through bit_cast
+template <typename T, typename S>
+inline constexpr bool rect_layout = std::is_standard_layout_v<rect<T, S>> && std::is_trivially_copyable_v<rect<T, S>>
+	&& sizeof(rect<T, S>) == 4 * sizeof(T)
+	&& std::bit_cast<std::array<T, 4>>(rect<T, S>(T{1}, T{2}, T{3}, T{4})) == std::array<T, 4>{T{1}, T{2}, T{3}, T{4}};
+
+} //ns detail
+
+static_assert(detail::point_layout<int> && detail::point_layout<unsigned> && detail::point_layout<float>);
+static_assert(detail::size_layout<int> && detail::size_layout<unsigned> && detail::size_layout<float>);
+static_assert(detail::rect_layout<int, int> && detail::rect_layout<int, unsigned> && detail::rect_layout<float, float>);
+
+namespace detail {
+
+template <typename E>
+struct scalars_of { static constexpr std::size_t count = 0; };
+template <typename T>
+struct scalars_of<point<T>> { using type = T; static constexpr std::size_t count = 2; };
+template <typename T>
+struct scalars_of<size<T>> { using type = T; static constexpr std::size_t count = 2; };
+template <typename T, typename S>
+struct scalars_of<rect<T, S>> { using type = T; static constexpr std::size_t count = 4; };
+
+template <typename From, typename To>
+using copy_const_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+/// element type of a contiguous range, const kept
+template <typename R>
+using element_t = std::remove_reference_t<std::ranges::range_reference_t<R>>;
+
+template <typename R>
+concept geom_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>
+	&& (scalars_of<std::remove_const_t<element_t<R>>>::count > 0);
+
+template <typename R>
+concept scalar_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>
+	&& std::is_arithmetic_v<element_t<R>>;
+
+} //ns detail
+
+/// points, sizes or rects of any contiguous range as a span of their coordinates
+template <detail::geom_range R>
+[[nodiscard]] inline auto as_scalars(R && r) noexcept {
+	using E = detail::element_t<R>;
+	using traits = detail::scalars_of<std::remove_const_t<E>>;
+	using T = detail::copy_const_t<E, typename traits::type>;
+	return std::span<T>(reinterpret_cast<T *>(std::ranges::data(r)), std::ranges::size(r) * traits::count);
+}
+
+template <detail::geom_range R>
+	requires std::is_same_v<typename detail::scalars_of<std::remove_const_t<detail::element_t<R>>>::type, float>
+[[nodiscard]] inline auto as_floats(R && r) noexcept { return as_scalars(std::forward<R>(r)); }
+
+/// scalars back to points, throws when the count is not a multiple of 2
+template <detail::scalar_range R>
+[[nodiscard]] inline auto as_points(R && v) {
+	using E = detail::element_t<R>;
+	using P = detail::copy_const_t<E, point<std::remove_const_t<E>>>;
+	if (std::ranges::size(v) % 2 != 0)
+		throw std::invalid_argument("Scalar count is not a multiple of 2");
+	return std::span<P>(reinterpret_cast<P *>(std::ranges::data(v)), std::ranges::size(v) / 2);
+}
+
+/// scalars back to rects, throws when the count is not a multiple of 4
+/// no unsigned size check is done, the data must already hold normalized rects
+template <typename S = void, detail::scalar_range R>
+[[nodiscard]] inline auto as_rects(R && v) {
+	using E = detail::element_t<R>;
+	using T = std::remove_const_t<E>;
+	using Rc = detail::copy_const_t<E, rect<T, std::conditional_t<std::is_void_v<S>, T, S>>>;
+	if (std::ranges::size(v) % 4 != 0)
+		throw std::invalid_argument("Scalar count is not a multiple of 4");
+	return std::span<Rc>(reinterpret_cast<Rc *>(std::ranges::data(v)), std::ranges::size(v) / 4);
+}
+
+/// value conversions
+template <typename T>
+[[nodiscard]] inline constexpr std::array<T, 2> to_array(const point<T> & p) noexcept { return std::bit_cast<std::array<T, 2>>(p); }
+template <typename T>
+[[nodiscard]] inline constexpr std::array<T, 2> to_array(const size<T> & s) noexcept { return std::bit_cast<std::array<T, 2>>(s); }
+template <typename T, typename S>
+[[nodiscard]] inline constexpr std::array<T, 4> to_array(const rect<T, S> & r) noexcept { return std::bit_cast<std::array<T, 4>>(r); }
+template <typename T, typename S = T>
+[[nodiscard]] inline constexpr rect<T, S> rect_from_array(const std::array<T, 4> & a) { return rect<T, S>(a[0], a[1], a[2], a[3]); }
+template <typename T>
+[[nodiscard]] inline constexpr point<T> point_from_array(const std::array<T, 2> & a) noexcept { return std::bit_cast<point<T>>(a); }
+
+} //ns geom
+
+#endif //GEOM_INTEROP_H
@@ -0,0 +1,374 @@
+#ifndef GEOM_LSM_INDEX_H
+#define GEOM_LSM_INDEX_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// log structured point index for high ingest rates: appends go to a buffer, full buffers become
+/// immutable Morton sorted runs and runs are merged in the background
+
+namespace geom {
+
+namespace detail {
+
+[[nodiscard]] inline constexpr std::uint32_t morton_spread16(std::uint32_t v) noexcept {
+	v &= 0xffffu;
+	v = (v | (v << 8)) & 0x00ff00ffu;
+	v = (v | (v << 4)) & 0x0f0f0f0fu;
+	v = (v | (v << 2)) & 0x33333333u;
+	return (v | (v << 1)) & 0x55555555u;
+}
+
+/// Morton code ranges [first, last] covering the cells [x1, x2] x [y1, y2] of a 65536 x 65536 grid
+/// quadtree cells are refined level by level while at most max_ranges cells result, cells partly inside
+/// the query are then covered whole, adjacent ranges are joined, ranges are ascending
+[[nodiscard]] inline std::vector<std::pair<std::uint32_t, std::uint32_t>> morton_ranges(std::uint32_t x1, std::uint32_t y1,
+	std::uint32_t x2, std::uint32_t y2, std::size_t max_ranges)
+{
+	/// cells are 2^level wide, full cells stop being refined
+	struct cell {
+		std::uint32_t x, y;
+		unsigned level;
+		bool full;
+	};
+	std::vector<cell> cur{{0, 0, 16, false}}, next;
+	for (unsigned level = 16; level > 0; --level) {
+		const std::uint32_t half = 1u << (level - 1);
+		next.clear();
+		bool partial = false;
+		for (const auto & c : cur) {
+			if (c.full) {
+				next.push_back(c);
+				continue;
+			}
+			/// children in Morton order
+			for (std::uint32_t k = 0; k < 4; ++k) {
+				const std::uint32_t cx = c.x + (k & 1u) * half, cy = c.y + (k >> 1) * half;
+				const std::uint32_t cx2 = cx + half - 1, cy2 = cy + half - 1;
+				if (cx > x2 || cx2 < x1 || cy > y2 || cy2 < y1)
+					continue;
+				const bool full = x1 <= cx && cx2 <= x2 && y1 <= cy && cy2 <= y2;
+				partial |= !full;
+				next.push_back({cx, cy, level - 1, full});
+			}
+		}
+		if (next.size() > max_ranges)
+			break;
+		std::swap(cur, next);
+		if (!partial)
+			break;
+	}
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+	for (const auto & c : cur) {
+		const std::uint32_t first = morton_spread16(c.x) | (morton_spread16(c.y) << 1);
+		const std::uint32_t last = first + static_cast<std::uint32_t>((std::uint64_t{1} << (2 * c.level)) - 1);
+		if (!ranges.empty() && ranges.back().second + 1 == first)
+			ranges.back().second = last;
+		else
+			ranges.emplace_back(first, last);
+	}
+	return ranges;
+}
+
+} //ns detail
+
+/// points with sequential ids in a fixed world rect (points outside are clamped to its border cells)
+/// one thread inserts, any thread queries, a worker thread owned by the index sorts full buffers into runs
+/// and merges fanout runs of the same tier into one of the next tier
+/// a query copies the current version (a shared_ptr, taken under a short lock) and reads it without locks:
+/// the filling buffer up to its published size, full buffers not sorted yet, and every run through the
+/// Morton ranges of the query rect
+template <typename T = float>
+class lsm_point_index {
+public:
+	using id_type = std::uint64_t;
+
+private:
+	/// entries below size are immutable, the inserting thread appends and publishes size
+	struct buffer {
+		explicit buffer(std::size_t capacity) : points(capacity), ids(capacity) {}
+		std::vector<point<T>> points;
+		std::vector<id_type> ids;
+		std::atomic<std::size_t> size{0};
+	};
+	/// sorted by (code, id)
+	struct run {
+		std::vector<std::uint32_t> codes;
+		std::vector<point<T>> points;
+		std::vector<id_type> ids;
+		unsigned tier = 0;
+	};
+	struct version {
+		std::shared_ptr<buffer> active;
+		std::vector<std::shared_ptr<const buffer>> frozen; /// full, oldest first
+		std::vector<std::shared_ptr<const run>> runs;
+	};
+
+public:
+	/// throws std::invalid_argument for an empty world, a zero buffer size or a fanout below 2
+	explicit lsm_point_index(const rect<T> & world, std::size_t buffer_size = std::size_t{1} << 16, unsigned fanout = 4, std::size_t max_ranges = 64)
+		: x0(static_cast<double>(world.left())), y0(static_cast<double>(world.top())), capacity(buffer_size), fanout(fanout), max_ranges(std::max<std::size_t>(max_ranges, 1))
+	{
+		if (!(world.right() > world.left()) || !(world.bottom() > world.top()))
+			throw std::invalid_argument("LSM index world rect is empty");
+		if (buffer_size == 0 || fanout < 2)
+			throw std::invalid_argument("LSM index needs a buffer and a fanout of at least 2");
+		sx = 65536.0 / (static_cast<double>(world.right()) - x0);
+		sy = 65536.0 / (static_cast<double>(world.bottom()) - y0);
+		auto v = std::make_shared<version>();
+		v->active = std::make_shared<buffer>(capacity);
+		active = v->active.get();
+		current = std::move(v);
+		worker = std::thread([this] { work(); });
+	}
+	lsm_point_index(const lsm_point_index &) = delete;
+	lsm_point_index & operator=(const lsm_point_index &) = delete;
+	~lsm_point_index() {
+		{
+			std::lock_guard lock(mutex);
+			stopping = true;
+		}
+		work_cv.notify_one();
+		worker.join();
+	}
+
+	/// inserting thread only, visible to queries on return
+	id_type insert(const point<T> & p) {
+		auto n = active->size.load(std::memory_order_relaxed);
+		if (n == capacity) {
+			freeze();
+			n = 0;
+		}
+		active->points[n] = p;
+		active->ids[n] = next_id;
+		active->size.store(n + 1, std::memory_order_release);
+		count.store(next_id + 1, std::memory_order_relaxed);
+		return next_id++;
+	}
+
+	/// inserting thread only, hands a partly filled buffer to the worker
+	void flush() {
+		if (active->size.load(std::memory_order_relaxed) != 0)
+			freeze();
+	}
+
+	/// blocks until the worker has sorted every full buffer and no tier has fanout runs
+	void wait_idle() {
+		std::unique_lock lock(mutex);
+		idle_cv.wait(lock, [&] { return !busy && !has_work(*current); });
+	}
+
+	[[nodiscard]] inline std::uint64_t size() const noexcept { return count.load(std::memory_order_relaxed); }
+	[[nodiscard]] std::size_t run_count() const {
+		std::lock_guard lock(mutex);
+		return current->runs.size();
+	}
+
+	/// points inside q (half-open like rect::contains), f(id, point) may return false to stop early
+	template <typename F>
+	void query(const rect<T> & q, F && f) const {
+		if (!(q.right() > q.left()) || !(q.bottom() > q.top()))
+			return;
+		const auto v = snapshot();
+		const auto emit = [&](id_type id, const point<T> & p) {
+			if constexpr (std::is_same_v<std::invoke_result_t<F &, id_type, const point<T> &>, bool>) {
+				return f(id, p);
+			} else {
+				f(id, p);
+				return true;
+			}
+		};
+		const auto scan = [&](const buffer & b) {
+			const auto n = b.size.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < n; ++i) {
+				if (q.contains(b.points[i]) && !emit(b.ids[i], b.points[i]))
+					return false;
+			}
+			return true;
+		};
+		if (!scan(*v->active))
+			return;
+		for (const auto & b : v->frozen) {
+			if (!scan(*b))
+				return;
+		}
+		if (v->runs.empty())
+			return;
+		const auto ranges = detail::morton_ranges(cell(q.left(), x0, sx), cell(q.top(), y0, sy), cell(q.right(), x0, sx), cell(q.bottom(), y0, sy), max_ranges);
+		for (const auto & r : v->runs) {
+			auto it = r->codes.begin();
+			for (const auto & [first, last] : ranges) {
+				it = std::lower_bound(it, r->codes.end(), first);
+				for (; it != r->codes.end() && *it <= last; ++it) {
+					const auto i = static_cast<std::size_t>(it - r->codes.begin());
+					if (q.contains(r->points[i]) && !emit(r->ids[i], r->points[i]))
+						return;
+				}
+			}
+		}
+	}
+
+private:
+	[[nodiscard]] static inline std::uint32_t cell(T v, double origin, double scale) noexcept {
+		const double c = std::floor((static_cast<double>(v) - origin) * scale);
+		return static_cast<std::uint32_t>(std::clamp(c, 0.0, 65535.0));
+	}
+	[[nodiscard]] inline std::uint32_t code_of(const point<T> & p) const noexcept {
+		return detail::morton_spread16(cell(p.x, x0, sx)) | (detail::morton_spread16(cell(p.y, y0, sy)) << 1);
+	}
+
+	[[nodiscard]] std::shared_ptr<const version> snapshot() const {
+		std::lock_guard lock(mutex);
+		return current;
+	}
+
+	/// versions are replaced, never modified, so snapshots stay valid
+	void freeze() {
+		auto fresh = std::make_shared<buffer>(capacity);
+		{
+			std::lock_guard lock(mutex);
+			auto v = std::make_shared<version>(*current);
+			v->frozen.push_back(std::move(v->active));
+			v->active = fresh;
+			current = std::move(v);
+		}
+		active = fresh.get();
+		work_cv.notify_one();
+	}
+
+	[[nodiscard]] bool has_work(const version & v) const noexcept {
+		return !v.frozen.empty() || mergeable_tier(v) != no_tier;
+	}
+	static constexpr unsigned no_tier = std::numeric_limits<unsigned>::max();
+	[[nodiscard]] unsigned mergeable_tier(const version & v) const noexcept {
+		std::vector<unsigned> per_tier;
+		for (const auto & r : v.runs) {
+			if (r->tier >= per_tier.size())
+				per_tier.resize(r->tier + 1);
+			if (++per_tier[r->tier] == fanout)
+				return r->tier;
+		}
+		return no_tier;
+	}
+
+	[[nodiscard]] std::shared_ptr<const run> sort_buffer(const buffer & b) const {
+		const auto n = b.size.load(std::memory_order_acquire);
+		std::vector<std::uint32_t> codes(n);
+		for (std::size_t i = 0; i < n; ++i)
+			codes[i] = code_of(b.points[i]);
+		/// ids ascend in a buffer, a stable sort keeps (code, id) order
+		std::vector<std::uint32_t> order(n);
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](std::uint32_t i, std::uint32_t j) { return codes[i] < codes[j]; });
+		auto r = std::make_shared<run>();
+		r->codes.reserve(n);
+		r->points.reserve(n);
+		r->ids.reserve(n);
+		for (const auto i : order) {
+			r->codes.push_back(codes[i]);
+			r->points.push_back(b.points[i]);
+			r->ids.push_back(b.ids[i]);
+		}
+		return r;
+	}
+
+	[[nodiscard]] static std::shared_ptr<const run> merge(const std::vector<std::shared_ptr<const run>> & in, unsigned tier) {
+		auto r = std::make_shared<run>();
+		r->tier = tier;
+		std::size_t n = 0;
+		for (const auto & s : in)
+			n += s->codes.size();
+		r->codes.reserve(n);
+		r->points.reserve(n);
+		r->ids.reserve(n);
+		std::vector<std::size_t> pos(in.size(), 0);
+		for (std::size_t k = 0; k < n; ++k) {
+			std::size_t best = in.size();
+			for (std::size_t s = 0; s < in.size(); ++s) {
+				if (pos[s] == in[s]->codes.size())
+					continue;
+				if (best == in.size() || std::pair(in[s]->codes[pos[s]], in[s]->ids[pos[s]]) < std::pair(in[best]->codes[pos[best]], in[best]->ids[pos[best]]))
+					best = s;
+			}
+			const auto & s = *in[best];
+			const auto i = pos[best]++;
+			r->codes.push_back(s.codes[i]);
+			r->points.push_back(s.points[i]);
+			r->ids.push_back(s.ids[i]);
+		}
+		return r;
+	}
+
+	/// worker thread: heavy work runs unlocked on immutable inputs, the result replaces them in whatever
+	/// version is current by then
+	void work() {
+		std::unique_lock lock(mutex);
+		while (!stopping) {
+			const auto v = current;
+			if (!v->frozen.empty()) {
+				const auto b = v->frozen.front();
+				busy = true;
+				lock.unlock();
+				auto r = sort_buffer(*b);
+				lock.lock();
+				auto next = std::make_shared<version>(*current);
+				next->frozen.erase(std::find(next->frozen.begin(), next->frozen.end(), b));
+				next->runs.push_back(std::move(r));
+				current = std::move(next);
+				continue;
+			}
+			if (const auto tier = mergeable_tier(*v); tier != no_tier) {
+				std::vector<std::shared_ptr<const run>> in;
+				for (const auto & r : v->runs) {
+					if (r->tier == tier && in.size() < fanout)
+						in.push_back(r);
+				}
+				busy = true;
+				lock.unlock();
+				auto r = merge(in, tier + 1);
+				lock.lock();
+				auto next = std::make_shared<version>(*current);
+				std::erase_if(next->runs, [&](const std::shared_ptr<const run> & x) { return std::find(in.begin(), in.end(), x) != in.end(); });
+				next->runs.push_back(std::move(r));
+				current = std::move(next);
+				continue;
+			}
+			busy = false;
+			idle_cv.notify_all();
+			work_cv.wait(lock);
+		}
+	}
+
+	double x0, y0, sx = 1, sy = 1;
+	std::size_t capacity;
+	unsigned fanout;
+	std::size_t max_ranges;
+
+	/// inserting thread state
+	buffer * active = nullptr;
+	id_type next_id = 0;
+	std::atomic<std::uint64_t> count{0};
+
+	mutable std::mutex mutex;
+	std::shared_ptr<const version> current;
+	std::condition_variable work_cv, idle_cv;
+	bool busy = false;
+	bool stopping = false;
+	std::thread worker;
+};
+
+} //ns geom
+
+#endif //GEOM_LSM_INDEX_H
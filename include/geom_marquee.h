@@ -0,0 +1,103 @@
+#ifndef GEOM_MARQUEE_H
+#define GEOM_MARQUEE_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_grid_index.h"
+
+/// incremental marquee (rubber band) selection
+
+namespace geom {
+
+enum class marquee_mode { intersects, contains };
+
+/// selection state of a dragged marquee over a grid_index
+/// an object can only change state if it touches the difference of two consecutive marquees,
+/// so update() queries just those strips and reports the added and removed ids
+/// marquees are normalized (left <= right, top <= bottom), in intersects mode a zero area marquee selects nothing
+template <typename T, typename S = T>
+class marquee_selection {
+public:
+	using id_type = typename grid_index<T, S>::id_type;
+
+	marquee_selection(const grid_index<T, S> & index, marquee_mode mode) noexcept : index(index), mode(mode) {}
+
+	/// starts a new drag, everything selected by r is reported as added
+	void begin(const rect<T, S> & r, std::vector<id_type> & added) {
+		clear();
+		index.query(r, [&](id_type id, const rect<T, S> & b) {
+			if (hit(r, b))
+				set(id, true, added);
+		});
+		current = r;
+	}
+
+	void update(const rect<T, S> & r, std::vector<id_type> & added, std::vector<id_type> & removed) {
+		if (!current) {
+			begin(r, added);
+			return;
+		}
+		const auto prev = *current;
+		current = r;
+		if (prev == r)
+			return;
+		const auto visit = [&](const rect<T, S> & strip) {
+			index.query(strip, [&](id_type id, const rect<T, S> & b) {
+				const bool now = hit(r, b);
+				if (now != is_selected(id))
+					set(id, now, now ? added : removed);
+			});
+		};
+		for_each_difference(r, prev, visit);
+		for_each_difference(prev, r, visit);
+	}
+
+	inline void clear() noexcept {
+		flags.clear();
+		selected.clear();
+		current.reset();
+	}
+	[[nodiscard]] inline bool is_selected(id_type id) const noexcept { return id < flags.size() && flags[id] != 0; }
+	[[nodiscard]] inline std::size_t count() const noexcept { return selected.size(); }
+	/// unordered
+	[[nodiscard]] inline std::span<const id_type> selection() const noexcept { return selected; }
+
+private:
+	[[nodiscard]] inline bool hit(const rect<T, S> & m, const rect<T, S> & b) const noexcept {
+		if (mode == marquee_mode::contains)
+			return m.contains(b);
+		/// a zero area marquee has no difference strips, it selects nothing
+		return !m.empty() && b.left() < m.right() && m.left() < b.right() && b.top() < m.bottom() && m.top() < b.bottom();
+	}
+
+	void set(id_type id, bool on, std::vector<id_type> & out) {
+		if (id >= flags.size()) {
+			flags.resize(id + 1, 0u);
+			slot.resize(id + 1, 0u);
+		}
+		flags[id] = on;
+		if (on) {
+			slot[id] = static_cast<id_type>(selected.size());
+			selected.push_back(id);
+		} else {
+			const auto s = slot[id];
+			selected[s] = selected.back();
+			slot[selected[s]] = s;
+			selected.pop_back();
+		}
+		out.push_back(id);
+	}
+
+	const grid_index<T, S> & index;
+	marquee_mode mode;
+	std::optional<rect<T, S>> current;
+	std::vector<std::uint8_t> flags;
+	std::vector<id_type> slot; /// position of a selected id in selected
+	std::vector<id_type> selected;
+};
+
+} //ns geom
+
+#endif //GEOM_MARQUEE_H
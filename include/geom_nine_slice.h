@@ -0,0 +1,116 @@
+#ifndef GEOM_NINE_SLICE_H
+#define GEOM_NINE_SLICE_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <array>
+#include <ranges>
+
+/// nine-slice (nine-patch) skin geometry: corners keep their size, edges stretch along one axis, the center along both
+
+namespace geom {
+
+/// destination and texture source rect of one slice
+/// layout {dst x1, y1, x2, y2, src x1, y1, x2, y2}, can be written straight into instance buffers
+template <typename T, typename S = T>
+struct slice_rects {
+	rect<T, S> dst{T{}, T{}, T{}, T{}};
+	rect<T, S> src{T{}, T{}, T{}, T{}};
+};
+
+static_assert(std::is_standard_layout_v<slice_rects<float>> && std::is_trivially_copyable_v<slice_rects<float>>
+	&& sizeof(slice_rects<float>) == 8 * sizeof(float));
+
+/// up to 9 slices in row major order, degenerate ones are left out
+template <typename T, typename S = T>
+struct nine_slices {
+	std::array<slice_rects<T, S>, 9> parts;
+	std::size_t count = 0;
+
+	[[nodiscard]] inline constexpr std::size_t size() const noexcept { return count; }
+	[[nodiscard]] inline constexpr bool empty() const noexcept { return count == 0; }
+	[[nodiscard]] inline constexpr const slice_rects<T, S> & operator[](std::size_t i) const noexcept { return parts[i]; }
+	[[nodiscard]] inline constexpr const slice_rects<T, S> * begin() const noexcept { return parts.data(); }
+	[[nodiscard]] inline constexpr const slice_rects<T, S> * end() const noexcept { return parts.data() + count; }
+};
+
+namespace detail {
+
+/// edges {lo, lo + a, hi - b, hi}, when a + b does not fit the extent both are scaled down proportionally
+template <typename T>
+[[nodiscard]] inline constexpr std::array<T, 4> slice_edges(T lo, T hi, T a, T b) noexcept {
+	const T ext = hi > lo ? static_cast<T>(hi - lo) : T{};
+	if (a + b > ext) {
+		if constexpr (std::is_floating_point_v<T>)
+			a = ext * a / (a + b);
+		else
+			a = static_cast<T>(static_cast<std::int64_t>(ext) * a / static_cast<std::int64_t>(a + b));
+		b = static_cast<T>(ext - a);
+	}
+	return { lo, static_cast<T>(lo + a), static_cast<T>(lo + ext - b), static_cast<T>(lo + ext) };
+}
+
+/// writes all 9 slices, advancing out only past non-degenerate ones, out must have room for 9
+template <typename T, typename S>
+inline std::size_t nine_slice_into(const rect<T, S> & dst, const rect<T, S> & src, const insets<T> & in, slice_rects<T, S> * out) noexcept {
+	const auto dx = slice_edges(dst.left(), dst.right(), in.left, in.right);
+	const auto dy = slice_edges(dst.top(), dst.bottom(), in.top, in.bottom);
+	const auto sx = slice_edges(src.left(), src.right(), in.left, in.right);
+	const auto sy = slice_edges(src.top(), src.bottom(), in.top, in.bottom);
+	std::size_t n = 0;
+	for (std::size_t r = 0; r < 3; ++r) {
+		for (std::size_t c = 0; c < 3; ++c) {
+			/// edges are ordered, the rect constructors cannot throw
+			auto & o = out[n];
+			o.dst = rect<T, S>(dx[c], dy[r], dx[c + 1], dy[r + 1]);
+			o.src = rect<T, S>(sx[c], sy[r], sx[c + 1], sy[r + 1]);
+			n += static_cast<std::size_t>((dx[c] < dx[c + 1]) & (dy[r] < dy[r + 1]) & (sx[c] < sx[c + 1]) & (sy[r] < sy[r + 1]));
+		}
+	}
+	return n;
+}
+
+} //ns detail
+
+/// slices dst and the skin image area src by the same border insets (non-negative)
+/// borders wider than dst or src are scaled down to fit, slices empty in dst or src are culled
+template <typename T, typename S>
+[[nodiscard]] inline nine_slices<T, S> nine_slice(const rect<T, S> & dst, const rect<T, S> & src, const std::type_identity_t<insets<T>> & in) noexcept {
+	nine_slices<T, S> res;
+	res.count = detail::nine_slice_into(dst, src, in, res.parts.data());
+	return res;
+}
+
+namespace detail {
+
+template <typename T, typename S>
+inline std::size_t nine_slice_bulk(std::span<const rect<T, S>> dst, std::span<const std::type_identity_t<rect<T, S>>> src,
+	std::span<const std::type_identity_t<insets<T>>> in, std::span<std::type_identity_t<slice_rects<T, S>>> out)
+{
+	if ((src.size() != 1 && src.size() != dst.size()) || (in.size() != 1 && in.size() != dst.size()))
+		throw std::invalid_argument("nine_slice source and insets counts must be 1 or the destination count");
+	if (out.size() < dst.size() * 9)
+		throw std::out_of_range("nine_slice output has room for less than 9 slices per widget");
+	const std::size_t src_step = src.size() == 1 ? 0 : 1, in_step = in.size() == 1 ? 0 : 1;
+	std::size_t n = 0;
+	for (std::size_t i = 0; i < dst.size(); ++i)
+		n += nine_slice_into(dst[i], src[i * src_step], in[i * in_step], out.data() + n);
+	return n;
+}
+
+} //ns detail
+
+/// bulk version for many widgets over contiguous ranges (vectors, arrays, spans), T and S come from the dst rects
+/// src and in hold either one entry shared by all widgets or one per widget
+/// slices are packed into out, which needs room for 9 per widget, returns the number written
+template <std::ranges::contiguous_range Dst, std::ranges::contiguous_range Src, std::ranges::contiguous_range In, std::ranges::contiguous_range Out>
+inline std::size_t nine_slice(const Dst & dst, const Src & src, const In & in, Out && out) {
+	return detail::nine_slice_bulk(std::span<const std::ranges::range_value_t<Dst>>(dst), std::span<const std::ranges::range_value_t<Src>>(src),
+		std::span<const std::ranges::range_value_t<In>>(in), std::span<std::ranges::range_value_t<Out>>(out));
+}
+
+} //ns geom
+
+#endif //GEOM_NINE_SLICE_H
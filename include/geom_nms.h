@@ -0,0 +1,178 @@
+#ifndef GEOM_NMS_H
+#define GEOM_NMS_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_simd.h"
+#include "geom_soa.h"
+#include <cstdint>
+#include <numeric> /// for iota
+
+/// iou matrix and non-maximum suppression over rectf_soa detection boxes
+
+namespace geom {
+
+namespace detail {
+
+/// out[j] = iou of box a with boxes[j] for j < count, four boxes per instruction and a scalar tail
+inline void iou_row(float ax1, float ay1, float ax2, float ay2, const rectf_soa & boxes, std::size_t count, float * out) noexcept {
+	using vec = simd::vec4<float>;
+	const float aa = (ax2 - ax1) * (ay2 - ay1);
+	const float * bx1 = boxes.x1.data(), * by1 = boxes.y1.data(), * bx2 = boxes.x2.data(), * by2 = boxes.y2.data();
+	const vec vx1 = vec::splat(ax1), vy1 = vec::splat(ay1), vx2 = vec::splat(ax2), vy2 = vec::splat(ay2);
+	const vec va = vec::splat(aa), zero = vec::splat(0.f);
+	std::size_t j = 0;
+	for (; j + 4u <= count; j += 4u) {
+		const vec x1 = vec::load(bx1 + j), y1 = vec::load(by1 + j), x2 = vec::load(bx2 + j), y2 = vec::load(by2 + j);
+		const vec w = max(min(vx2, x2) - max(vx1, x1), zero);
+		const vec h = max(min(vy2, y2) - max(vy1, y1), zero);
+		const vec in = w * h;
+		const vec un = va + (x2 - x1) * (y2 - y1) - in;
+		/// lanes with an empty union divide by zero and are replaced by 0
+		select_lt(zero, un, in / un, zero).store(out + j);
+	}
+	for (; j < count; ++j) {
+		const float w = std::max(std::min(ax2, bx2[j]) - std::max(ax1, bx1[j]), 0.f);
+		const float h = std::max(std::min(ay2, by2[j]) - std::max(ay1, by1[j]), 0.f);
+		const float in = w * h;
+		const float un = aa + (bx2[j] - bx1[j]) * (by2[j] - by1[j]) - in;
+		out[j] = un > 0.f ? in / un : 0.f;
+	}
+}
+
+} //ns detail
+
+/// row-major boxes.size() x boxes.size() iou matrix
+inline void iou_matrix(const rectf_soa & boxes, std::span<float> out) {
+	const std::size_t n = boxes.size();
+	if (out.size() < n * n)
+		throw std::invalid_argument("iou_matrix output is too small");
+	for (std::size_t i = 0; i < n; ++i)
+		detail::iou_row(boxes.x1[i], boxes.y1[i], boxes.x2[i], boxes.y2[i], boxes, n, out.data() + i * n);
+}
+
+namespace detail {
+
+/// boxes reordered by descending score and padded with empty boxes to a multiple of 64
+struct nms_sorted {
+	std::vector<std::size_t> order;
+	std::vector<float> x1, y1, x2, y2, area;
+
+	nms_sorted(const rectf_soa & boxes, std::span<const float> scores) : order(boxes.size()) {
+		if (scores.size() != boxes.size())
+			throw std::invalid_argument("Scores do not match boxes");
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return scores[a] > scores[b]; });
+		const std::size_t padded = (order.size() + 63u) & ~std::size_t{63u};
+		x1.resize(padded); y1.resize(padded); x2.resize(padded); y2.resize(padded); area.resize(padded);
+		for (std::size_t i = 0; i < order.size(); ++i) {
+			const auto k = order[i];
+			x1[i] = boxes.x1[k]; y1[i] = boxes.y1[k]; x2[i] = boxes.x2[k]; y2[i] = boxes.y2[k];
+			area[i] = (x2[i] - x1[i]) * (y2[i] - y1[i]);
+		}
+	}
+
+	/// bit k of the result is set when box (j + k) overlaps box i by more than threshold
+	[[nodiscard]] std::uint64_t suppress_mask(std::size_t i, std::size_t j, float threshold) const noexcept {
+		using vec = simd::vec4<float>;
+		const vec ax1 = vec::splat(x1[i]), ay1 = vec::splat(y1[i]), ax2 = vec::splat(x2[i]), ay2 = vec::splat(y2[i]);
+		const vec aa = vec::splat(area[i]), thr = vec::splat(threshold), zero = vec::splat(0.f);
+		std::uint64_t m = 0;
+		for (unsigned k = 0; k < 64u; k += 4u) {
+			const vec w = max(min(ax2, vec::load(&x2[j + k])) - max(ax1, vec::load(&x1[j + k])), zero);
+			const vec h = max(min(ay2, vec::load(&y2[j + k])) - max(ay1, vec::load(&y1[j + k])), zero);
+			const vec in = w * h;
+			const vec un = aa + vec::load(&area[j + k]) - in;
+			/// iou > threshold without the division
+			m |= std::uint64_t{cmplt(thr * un, in)} << k;
+		}
+		return m;
+	}
+};
+
+} //ns detail
+
+/// greedy nms, returns indices of kept boxes by descending score
+/// suppression state is a bitmask like in GPU nms, overlaps are tested four boxes per instruction
+inline std::vector<std::size_t> nms(const rectf_soa & boxes, std::span<const float> scores, float iou_threshold) {
+	const detail::nms_sorted s(boxes, scores);
+	const std::size_t n = s.order.size();
+	std::vector<std::uint64_t> removed(s.x1.size() / 64u, 0u);
+	std::vector<std::size_t> keep;
+	for (std::size_t i = 0; i < n; ++i) {
+		if (removed[i / 64u] & (std::uint64_t{1} << (i % 64u)))
+			continue;
+		keep.push_back(s.order[i]);
+		const std::size_t w0 = i / 64u;
+		/// the word holding i is masked to boxes after i
+		removed[w0] |= s.suppress_mask(i, w0 * 64u, iou_threshold) & (~std::uint64_t{1} << (i % 64u));
+		for (std::size_t w = w0 + 1; w < removed.size(); ++w) {
+			if (removed[w] != ~std::uint64_t{0})
+				removed[w] |= s.suppress_mask(i, w * 64u, iou_threshold);
+		}
+	}
+	return keep;
+}
+
+enum class soft_nms_method { linear, gaussian };
+
+struct scored_index {
+	std::size_t index;
+	float score;
+};
+
+/// soft-nms (Bodla et al.), overlapping boxes get their score decayed instead of being removed
+/// linear: score *= 1 - iou when iou > iou_threshold, gaussian: score *= exp(-iou^2 / sigma)
+/// boxes whose score drops below score_threshold are discarded, result is in selection order
+inline std::vector<scored_index> soft_nms(const rectf_soa & boxes, std::span<const float> scores, soft_nms_method method,
+	float iou_threshold, float sigma, float score_threshold) {
+	if (scores.size() != boxes.size())
+		throw std::invalid_argument("Scores do not match boxes");
+	/// live boxes are kept compacted at the front so the decay loop stays dense
+	std::vector<std::size_t> idx(boxes.size());
+	std::iota(idx.begin(), idx.end(), std::size_t{0});
+	rectf_soa b = boxes;
+	std::vector<float> sc(scores.begin(), scores.end());
+	std::vector<float> overlap(boxes.size());
+	std::vector<scored_index> result;
+	std::size_t n = idx.size();
+	const float inv_sigma = 1.f / sigma;
+	while (n > 0) {
+		const auto best = static_cast<std::size_t>(std::max_element(sc.begin(), sc.begin() + n) - sc.begin());
+		if (sc[best] < score_threshold)
+			break;
+		result.push_back({idx[best], sc[best]});
+		const float ax1 = b.x1[best], ay1 = b.y1[best], ax2 = b.x2[best], ay2 = b.y2[best];
+		--n;
+		std::swap(idx[best], idx[n]); std::swap(sc[best], sc[n]);
+		std::swap(b.x1[best], b.x1[n]); std::swap(b.y1[best], b.y1[n]);
+		std::swap(b.x2[best], b.x2[n]); std::swap(b.y2[best], b.y2[n]);
+		/// overlaps with the live boxes come from the vec4 kernel, only the decay is per box
+		detail::iou_row(ax1, ay1, ax2, ay2, b, n, overlap.data());
+		for (std::size_t j = 0; j < n; ++j) {
+			const float o = overlap[j];
+			const float decay = method == soft_nms_method::linear
+				? (o > iou_threshold ? 1.f - o : 1.f)
+				: std::exp(-o * o * inv_sigma);
+			sc[j] *= decay;
+		}
+		/// drop boxes that fell under the threshold
+		for (std::size_t j = 0; j < n;) {
+			if (sc[j] < score_threshold) {
+				--n;
+				std::swap(idx[j], idx[n]); std::swap(sc[j], sc[n]);
+				std::swap(b.x1[j], b.x1[n]); std::swap(b.y1[j], b.y1[n]);
+				std::swap(b.x2[j], b.x2[n]); std::swap(b.y2[j], b.y2[n]);
+			} else {
+				++j;
+			}
+		}
+	}
+	return result;
+}
+
+} //ns geom
+
+#endif //GEOM_NMS_H
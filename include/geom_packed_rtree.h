@@ -0,0 +1,642 @@
+#ifndef GEOM_PACKED_RTREE_H
+#define GEOM_PACKED_RTREE_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring> /// for memcpy
+#include <functional> /// for greater
+#include <limits>
+#include <queue>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// static packed Hilbert R-tree stored in a file and queried through a read only memory mapping
+/// file: 64 byte header, boxes of all levels (items in Hilbert order first, the root last), then item ids
+/// every node holds node_size children stored next to each other, nothing is deserialized on open
+
+namespace geom {
+
+struct packed_rtree_header {
+	char magic[8];
+	std::uint8_t coord_type; /// detail::scalar_tag of T and S
+	std::uint8_t size_type;
+	std::uint16_t node_size;
+	std::uint16_t byte_order; /// 0x0102 as written, files are not portable across byte orders
+	std::uint16_t reserved;
+	std::uint64_t count; /// items
+	std::uint64_t box_count; /// boxes of all levels
+	std::uint8_t padding[32];
+};
+static_assert(sizeof(packed_rtree_header) == 64);
+
+namespace detail {
+
+inline constexpr char packed_rtree_magic[8] = {'G', 'E', 'O', 'M', 'H', 'R', 'T', '1'};
+
+/// kind in the high nibble (0 unsigned, 1 signed, 2 floating point), bytes in the low nibble
+template <typename T>
+[[nodiscard]] inline constexpr std::uint8_t scalar_tag() noexcept {
+	const unsigned kind = std::is_floating_point_v<T> ? 2 : (std::is_signed_v<T> ? 1 : 0);
+	return static_cast<std::uint8_t>(kind << 4 | sizeof(T));
+}
+
+/// cumulative box counts at the end of each level, level 0 being the items
+[[nodiscard]] inline std::vector<std::uint64_t> packed_levels(std::uint64_t count, std::uint64_t node_size) {
+	std::vector<std::uint64_t> ends;
+	if (count == 0)
+		return ends;
+	std::uint64_t n = count, total = count;
+	ends.push_back(total);
+	do {
+		n = (n + node_size - 1) / node_size;
+		total += n;
+		ends.push_back(total);
+	} while (n != 1);
+	return ends;
+}
+
+/// index on the Hilbert curve of a cell of a 65536 x 65536 grid
+[[nodiscard]] inline constexpr std::uint32_t hilbert_index(std::uint32_t x, std::uint32_t y) noexcept {
+	std::uint32_t a = x ^ y, b = 0xffffu ^ a, c = 0xffffu ^ (x | y), d = x & (y ^ 0xffffu);
+	std::uint32_t A = a | (b >> 1), B = (a >> 1) ^ a;
+	std::uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c, D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+	a = A; b = B; c = C; d = D;
+	A = (a & (a >> 2)) ^ (b & (b >> 2));
+	B = (a & (b >> 2)) ^ (b & ((a ^ b) >> 2));
+	C ^= (a & (c >> 2)) ^ (b & (d >> 2));
+	D ^= (b & (c >> 2)) ^ ((a ^ b) & (d >> 2));
+	a = A; b = B; c = C; d = D;
+	A = (a & (a >> 4)) ^ (b & (b >> 4));
+	B = (a & (b >> 4)) ^ (b & ((a ^ b) >> 4));
+	C ^= (a & (c >> 4)) ^ (b & (d >> 4));
+	D ^= (b & (c >> 4)) ^ ((a ^ b) & (d >> 4));
+	a = A; b = B; c = C; d = D;
+	C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+	D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+	a = C ^ (C >> 1);
+	b = D ^ (D >> 1);
+	const auto spread = [](std::uint32_t v) {
+		v = (v | (v << 8)) & 0x00ff00ffu;
+		v = (v | (v << 4)) & 0x0f0f0f0fu;
+		v = (v | (v << 2)) & 0x33333333u;
+		return (v | (v << 1)) & 0x55555555u;
+	};
+	const std::uint32_t i0 = x ^ y, i1 = b | (0xffffu ^ (i0 | a));
+	return (spread(i1 & 0xffffu) << 1) | spread(i0 & 0xffffu);
+}
+
+struct file_closer {
+	void operator()(std::FILE * f) const noexcept { std::fclose(f); }
+};
+using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+[[nodiscard]] inline file_ptr temp_file() {
+	file_ptr f(std::tmpfile());
+	if (!f)
+		throw std::system_error(errno, std::generic_category(), "Cannot create a temporary file");
+	return f;
+}
+
+inline void write_all(std::FILE * f, const void * p, std::size_t n) {
+	if (n != 0 && std::fwrite(p, 1, n, f) != n)
+		throw std::system_error(errno, std::generic_category(), "Write failed");
+}
+
+inline void read_all(std::FILE * f, void * p, std::size_t n) {
+	if (n != 0 && std::fread(p, 1, n, f) != n)
+		throw std::system_error(errno ? errno : EIO, std::generic_category(), "Read failed");
+}
+
+/// buffered sequential writes of fixed size records
+class block_writer {
+public:
+	explicit block_writer(std::FILE * f) : f(f) { buf.reserve(capacity); }
+	template <typename R>
+	inline void put(const R & r) {
+		if (buf.size() + sizeof(R) > capacity)
+			flush();
+		const auto old = buf.size();
+		buf.resize(old + sizeof(R));
+		std::memcpy(buf.data() + old, &r, sizeof(R));
+	}
+	inline void flush() {
+		write_all(f, buf.data(), buf.size());
+		buf.clear();
+	}
+
+private:
+	static constexpr std::size_t capacity = 1 << 20;
+	std::FILE * f;
+	std::vector<unsigned char> buf;
+};
+
+} //ns detail
+
+/// builds a packed_rtree file from any number of rects with bounded memory
+/// add() keeps up to memory_items rects in memory and spills the rest to a temporary file, finish() sorts
+/// by the Hilbert index of the centers in runs of memory_items, merges the runs into the file and writes
+/// the upper levels one at a time, every pass is sequential
+template <typename T, typename S = T>
+class packed_rtree_writer {
+	static_assert(std::is_trivially_copyable_v<rect<T, S>> && sizeof(rect<T, S>) == 4 * sizeof(T), "rect must be 4 packed coordinates");
+	using box = std::array<T, 4>;
+	struct record {
+		std::uint32_t key;
+		std::uint64_t id;
+		box b;
+	};
+	[[nodiscard]] static inline bool before(const record & a, const record & b) noexcept { return a.key != b.key ? a.key < b.key : a.id < b.id; }
+
+public:
+	using id_type = std::uint64_t;
+
+	/// throws std::invalid_argument for node sizes outside [2, 65535] or a zero memory budget
+	explicit packed_rtree_writer(std::string path, std::size_t node_size = 16, std::size_t memory_items = std::size_t{1} << 22)
+		: path(std::move(path)), node(node_size), budget(memory_items)
+	{
+		if (node_size < 2 || node_size > std::numeric_limits<std::uint16_t>::max())
+			throw std::invalid_argument("Packed R-tree node size must be in [2, 65535]");
+		if (memory_items == 0)
+			throw std::invalid_argument("Packed R-tree writer needs memory for at least one item");
+		buffer.reserve(std::min<std::size_t>(budget, 1 << 16));
+	}
+
+	/// ids are assigned in order of addition
+	id_type add(const rect<T, S> & r) {
+		if (buffer.size() == budget) {
+			if (!spill)
+				spill = detail::temp_file();
+			detail::write_all(spill.get(), buffer.data(), buffer.size() * sizeof(box));
+			buffer.clear();
+		}
+		buffer.push_back({r.left(), r.top(), r.right(), r.bottom()});
+		const double cx = static_cast<double>(r.left()) + static_cast<double>(r.right());
+		const double cy = static_cast<double>(r.top()) + static_cast<double>(r.bottom());
+		lo[0] = std::min(lo[0], cx); hi[0] = std::max(hi[0], cx);
+		lo[1] = std::min(lo[1], cy); hi[1] = std::max(hi[1], cy);
+		return count++;
+	}
+	[[nodiscard]] inline std::uint64_t size() const noexcept { return count; }
+
+	/// writes the file and starts over empty, throws std::system_error on I/O errors
+	void finish() {
+		detail::file_ptr out(std::fopen(path.c_str(), "wb"));
+		if (!out)
+			throw std::system_error(errno, std::generic_category(), "Cannot create " + path);
+		const auto levels = detail::packed_levels(count, node);
+		packed_rtree_header h{};
+		std::memcpy(h.magic, detail::packed_rtree_magic, sizeof(h.magic));
+		h.coord_type = detail::scalar_tag<T>();
+		h.size_type = detail::scalar_tag<S>();
+		h.node_size = static_cast<std::uint16_t>(node);
+		h.byte_order = 0x0102;
+		h.count = count;
+		h.box_count = levels.empty() ? 0 : levels.back();
+		detail::write_all(out.get(), &h, sizeof(h));
+		if (count != 0) {
+			detail::block_writer boxes(out.get());
+			auto ids = detail::temp_file();
+			auto parents = detail::temp_file();
+			{
+				detail::block_writer id_out(ids.get()), parent_out(parents.get());
+				level_writer lw{boxes, parent_out, node};
+				sorted([&](const record & r) {
+					lw.put(r.b);
+					id_out.put(r.id);
+				});
+				lw.close();
+				id_out.flush();
+				parent_out.flush();
+			}
+			/// level l + 1 is copied to the file while level l + 2 is computed from it
+			for (std::size_t l = 1; l < levels.size(); ++l) {
+				auto next = detail::temp_file();
+				std::rewind(parents.get());
+				detail::block_writer next_out(next.get());
+				level_writer lw{boxes, next_out, node};
+				copy_boxes(parents.get(), levels[l] - levels[l - 1], [&](const box & b) { lw.put(b); });
+				lw.close();
+				next_out.flush();
+				parents = std::move(next);
+			}
+			boxes.flush();
+			std::rewind(ids.get());
+			std::vector<unsigned char> chunk(1 << 20);
+			for (std::uint64_t left = count * sizeof(id_type); left != 0;) {
+				const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(left, chunk.size()));
+				detail::read_all(ids.get(), chunk.data(), n);
+				detail::write_all(out.get(), chunk.data(), n);
+				left -= n;
+			}
+		}
+		if (std::fclose(out.release()) != 0)
+			throw std::system_error(errno, std::generic_category(), "Cannot write " + path);
+		buffer.clear();
+		spill.reset();
+		count = 0;
+		lo[0] = lo[1] = std::numeric_limits<double>::max();
+		hi[0] = hi[1] = std::numeric_limits<double>::lowest();
+	}
+
+private:
+	/// writes boxes of one level and their parents, node children at a time
+	struct level_writer {
+		detail::block_writer & boxes;
+		detail::block_writer & parents;
+		std::size_t node;
+		std::size_t n = 0;
+		box u{};
+
+		inline void put(const box & b) {
+			boxes.put(b);
+			if (n++ == 0) {
+				u = b;
+			} else {
+				u[0] = std::min(u[0], b[0]); u[1] = std::min(u[1], b[1]);
+				u[2] = std::max(u[2], b[2]); u[3] = std::max(u[3], b[3]);
+			}
+			if (n == node)
+				close();
+		}
+		inline void close() {
+			if (n != 0)
+				parents.put(u);
+			n = 0;
+		}
+	};
+
+	template <typename F>
+	static void copy_boxes(std::FILE * f, std::uint64_t n, F && f_box) {
+		std::vector<box> chunk(std::size_t{1} << 16);
+		while (n != 0) {
+			const auto k = static_cast<std::size_t>(std::min<std::uint64_t>(n, chunk.size()));
+			detail::read_all(f, chunk.data(), k * sizeof(box));
+			for (std::size_t i = 0; i < k; ++i)
+				f_box(chunk[i]);
+			n -= k;
+		}
+	}
+
+	[[nodiscard]] inline std::uint32_t key_of(const box & b) const noexcept {
+		const auto q = [&](double v, int a) {
+			return hi[a] > lo[a] ? static_cast<std::uint32_t>((v - lo[a]) / (hi[a] - lo[a]) * 65535.0) : 0u;
+		};
+		return detail::hilbert_index(q(static_cast<double>(b[0]) + static_cast<double>(b[2]), 0),
+			q(static_cast<double>(b[1]) + static_cast<double>(b[3]), 1));
+	}
+
+	/// calls f with all records in Hilbert order
+	template <typename F>
+	void sorted(F && f) {
+		std::vector<record> recs;
+		if (!spill) {
+			recs.reserve(buffer.size());
+			for (std::uint64_t i = 0; i < buffer.size(); ++i)
+				recs.push_back({key_of(buffer[i]), i, buffer[i]});
+			std::sort(recs.begin(), recs.end(), before);
+			for (const auto & r : recs)
+				f(r);
+			return;
+		}
+		detail::write_all(spill.get(), buffer.data(), buffer.size() * sizeof(box));
+		buffer = {};
+		std::rewind(spill.get());
+
+		/// sorted runs of budget records
+		std::vector<detail::file_ptr> runs;
+		std::vector<box> chunk;
+		recs.reserve(budget);
+		for (std::uint64_t first = 0; first < count; first += budget) {
+			const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(budget, count - first));
+			chunk.resize(n);
+			detail::read_all(spill.get(), chunk.data(), n * sizeof(box));
+			recs.clear();
+			for (std::size_t i = 0; i < n; ++i)
+				recs.push_back({key_of(chunk[i]), first + i, chunk[i]});
+			std::sort(recs.begin(), recs.end(), before);
+			runs.push_back(detail::temp_file());
+			detail::write_all(runs.back().get(), recs.data(), n * sizeof(record));
+			std::rewind(runs.back().get());
+		}
+		spill.reset();
+		chunk = {};
+		recs = {};
+
+		/// k-way merge, every run read through its own buffer
+		struct cursor {
+			std::FILE * f;
+			std::uint64_t left;
+			std::vector<record> buf;
+			std::size_t pos = 0;
+		};
+		std::vector<cursor> cur;
+		const std::size_t per_run = std::max<std::size_t>(budget / runs.size(), 1024);
+		for (std::size_t i = 0; i < runs.size(); ++i) {
+			const std::uint64_t n = std::min<std::uint64_t>(budget, count - i * static_cast<std::uint64_t>(budget));
+			cur.push_back({runs[i].get(), n, {}, 0});
+		}
+		const auto refill = [&](cursor & c) {
+			const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(c.left, per_run));
+			c.buf.resize(n);
+			detail::read_all(c.f, c.buf.data(), n * sizeof(record));
+			c.left -= n;
+			c.pos = 0;
+		};
+		const auto later = [&](std::size_t a, std::size_t b) { return before(cur[b].buf[cur[b].pos], cur[a].buf[cur[a].pos]); };
+		std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heads(later);
+		for (std::size_t i = 0; i < cur.size(); ++i) {
+			refill(cur[i]);
+			heads.push(i);
+		}
+		while (!heads.empty()) {
+			const auto i = heads.top();
+			heads.pop();
+			auto & c = cur[i];
+			f(c.buf[c.pos]);
+			if (++c.pos == c.buf.size()) {
+				if (c.left == 0)
+					continue;
+				refill(c);
+			}
+			heads.push(i);
+		}
+	}
+
+	std::string path;
+	std::size_t node;
+	std::size_t budget;
+	std::vector<box> buffer;
+	detail::file_ptr spill;
+	std::uint64_t count = 0;
+	double lo[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+	double hi[2] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+};
+
+/// read only view of a packed_rtree_writer file mapped into memory, opening is O(1) apart from validation
+/// the mapping is advised for random access and the top levels, up to prefetch_bytes, are prefetched,
+/// a query reads one node_size box block per visited node
+template <typename T, typename S = T>
+class packed_rtree {
+	static_assert(std::is_trivially_copyable_v<rect<T, S>> && sizeof(rect<T, S>) == 4 * sizeof(T), "rect must be 4 packed coordinates");
+public:
+	using id_type = std::uint64_t;
+
+	/// throws std::system_error when the file cannot be mapped, std::invalid_argument when it is not
+	/// a packed R-tree of rect<T, S>
+	explicit packed_rtree(const std::string & path, std::size_t prefetch_bytes = std::size_t{64} << 20) {
+		map(path);
+		try {
+			if (length < sizeof(packed_rtree_header))
+				throw std::invalid_argument("Not a packed R-tree file: " + path);
+			packed_rtree_header h;
+			std::memcpy(&h, data, sizeof(h));
+			if (std::memcmp(h.magic, detail::packed_rtree_magic, sizeof(h.magic)) != 0 || h.byte_order != 0x0102 || h.node_size < 2)
+				throw std::invalid_argument("Not a packed R-tree file: " + path);
+			if (h.coord_type != detail::scalar_tag<T>() || h.size_type != detail::scalar_tag<S>())
+				throw std::invalid_argument("Packed R-tree file has other coordinate types: " + path);
+			if (h.count > (length - sizeof(h)) / (sizeof(rect<T, S>) + sizeof(id_type)))
+				throw std::invalid_argument("Packed R-tree file is truncated or corrupt: " + path);
+			node = h.node_size;
+			levels = detail::packed_levels(h.count, node);
+			const std::uint64_t boxes_n = levels.empty() ? 0 : levels.back();
+			if (h.box_count != boxes_n || length != sizeof(h) + boxes_n * sizeof(rect<T, S>) + h.count * sizeof(id_type))
+				throw std::invalid_argument("Packed R-tree file is truncated or corrupt: " + path);
+			const auto * p = static_cast<const unsigned char *>(data) + sizeof(h);
+			all = {reinterpret_cast<const rect<T, S> *>(p), static_cast<std::size_t>(boxes_n)};
+			id_list = {reinterpret_cast<const id_type *>(p + boxes_n * sizeof(rect<T, S>)), static_cast<std::size_t>(h.count)};
+			stack_need = levels.empty() ? 1 : (levels.size() - 1) * (node - 1) + 1;
+			advise(prefetch_bytes);
+		} catch (...) {
+			unmap();
+			throw;
+		}
+	}
+	packed_rtree(packed_rtree && o) noexcept
+		: data(std::exchange(o.data, nullptr)), length(std::exchange(o.length, 0)), node(o.node), levels(std::move(o.levels)),
+		all(o.all), id_list(o.id_list), stack_need(o.stack_need) {}
+	packed_rtree & operator=(packed_rtree &&) = delete;
+	~packed_rtree() { unmap(); }
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return id_list.size(); }
+	[[nodiscard]] inline std::size_t node_size() const noexcept { return node; }
+	[[nodiscard]] inline std::size_t level_count() const noexcept { return levels.size(); }
+	/// boxes of level l, level 0 are the items in tree order, the last level is the root
+	[[nodiscard]] inline std::span<const rect<T, S>> level(std::size_t l) const {
+		const auto first = l == 0 ? 0 : levels.at(l - 1);
+		return all.subspan(static_cast<std::size_t>(first), static_cast<std::size_t>(levels.at(l) - first));
+	}
+	/// item boxes in tree order and their ids (insertion order of the writer)
+	[[nodiscard]] inline std::span<const rect<T, S>> items() const noexcept { return all.first(id_list.size()); }
+	[[nodiscard]] inline std::span<const id_type> ids() const noexcept { return id_list; }
+	/// bounds of all items, nullopt when empty
+	[[nodiscard]] inline std::optional<rect<T, S>> bounds() const noexcept {
+		return all.empty() ? std::nullopt : std::optional<rect<T, S>>(all.back());
+	}
+
+	/// items overlapping q with a positive area, f(id, rect) may return false to stop early
+	template <typename F>
+	void query(const rect<T, S> & q, F && f) const {
+		traverse([&](const rect<T, S> & b) {
+			return b.left() <= q.right() && q.left() <= b.right() && b.top() <= q.bottom() && q.top() <= b.bottom();
+		}, [&](const rect<T, S> & r) {
+			return std::max(r.left(), q.left()) < std::min(r.right(), q.right()) && std::max(r.top(), q.top()) < std::min(r.bottom(), q.bottom());
+		}, f);
+	}
+
+	/// items containing pt (half-open like rect::contains)
+	template <typename F>
+	void query(const point<T> & pt, F && f) const {
+		traverse([&](const rect<T, S> & b) {
+			return b.left() <= pt.x && pt.x <= b.right() && b.top() <= pt.y && pt.y <= b.bottom();
+		}, [&](const rect<T, S> & r) { return r.contains(pt); }, f);
+	}
+
+	/// up to k items closest to pt by box distance (0 inside), ascending, with their squared distances
+	/// nodes are expanded best first, so only nodes closer than the k-th item are read
+	[[nodiscard]] std::vector<std::pair<id_type, double>> nearest(const point<T> & pt, std::size_t k,
+		double max_distance = std::numeric_limits<double>::infinity()) const
+	{
+		std::vector<std::pair<id_type, double>> out;
+		if (all.empty() || k == 0)
+			return out;
+		const double max_d2 = max_distance * max_distance;
+		/// (squared distance, box index), items are the boxes below size()
+		using entry = std::pair<double, std::uint64_t>;
+		std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+		open.emplace(0., all.size() - 1);
+		while (!open.empty()) {
+			const auto [d2, pos] = open.top();
+			open.pop();
+			if (d2 > max_d2)
+				break;
+			if (pos < id_list.size()) {
+				out.emplace_back(id_list[static_cast<std::size_t>(pos)], d2);
+				if (out.size() == k)
+					break;
+				continue;
+			}
+			const auto [first, last] = children(pos);
+			for (auto c = first; c < last; ++c) {
+				const auto & b = all[static_cast<std::size_t>(c)];
+				const double dx = std::max({static_cast<double>(b.left()) - static_cast<double>(pt.x), 0., static_cast<double>(pt.x) - static_cast<double>(b.right())});
+				const double dy = std::max({static_cast<double>(b.top()) - static_cast<double>(pt.y), 0., static_cast<double>(pt.y) - static_cast<double>(b.bottom())});
+				open.emplace(dx * dx + dy * dy, c);
+			}
+		}
+		return out;
+	}
+
+private:
+	/// children [first, last) of the node box at pos, above level 0
+	[[nodiscard]] inline std::pair<std::uint64_t, std::uint64_t> children(std::uint64_t pos) const noexcept {
+		std::size_t l = 1;
+		while (pos >= levels[l])
+			++l;
+		const auto below = l >= 2 ? levels[l - 2] : 0;
+		const auto first = below + (pos - levels[l - 1]) * node;
+		return {first, std::min(first + node, levels[l - 1])};
+	}
+
+	template <typename Test, typename Prim, typename F>
+	void traverse(Test && test, Prim && prim, F && f) const {
+		if (all.empty())
+			return;
+		/// (box index, level) of nodes still to visit
+		constexpr std::size_t fixed_stack = 256;
+		std::pair<std::uint64_t, std::size_t> fixed[fixed_stack];
+		std::vector<std::pair<std::uint64_t, std::size_t>> heap;
+		auto * stack = fixed;
+		if (stack_need > fixed_stack) {
+			heap.resize(stack_need);
+			stack = heap.data();
+		}
+		std::size_t sp = 0;
+		if (test(all.back()))
+			stack[sp++] = {all.size() - 1, levels.size() - 1};
+		while (sp != 0) {
+			const auto [pos, l] = stack[--sp];
+			const auto below = l >= 2 ? levels[l - 2] : 0;
+			const auto first = below + (pos - levels[l - 1]) * node;
+			const auto last = std::min(first + node, levels[l - 1]);
+			for (auto c = first; c < last; ++c) {
+				const auto & b = all[static_cast<std::size_t>(c)];
+				if (l > 1) {
+					if (test(b))
+						stack[sp++] = {c, l - 1};
+					continue;
+				}
+				if (!prim(b))
+					continue;
+				if constexpr (std::is_same_v<std::invoke_result_t<F &, id_type, const rect<T, S> &>, bool>) {
+					if (!f(id_list[static_cast<std::size_t>(c)], b))
+						return;
+				} else {
+					f(id_list[static_cast<std::size_t>(c)], b);
+				}
+			}
+		}
+	}
+
+#ifdef _WIN32
+	void map(const std::string & path) {
+		const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Cannot open " + path);
+		LARGE_INTEGER sz{};
+		if (!GetFileSizeEx(file, &sz)) {
+			const auto e = GetLastError();
+			CloseHandle(file);
+			throw std::system_error(static_cast<int>(e), std::system_category(), "Cannot open " + path);
+		}
+		if (sz.QuadPart == 0) {
+			CloseHandle(file);
+			throw std::invalid_argument("Not a packed R-tree file: " + path);
+		}
+		const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mapping)
+			throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Cannot map " + path);
+		data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		const auto e = GetLastError();
+		CloseHandle(mapping);
+		if (!data)
+			throw std::system_error(static_cast<int>(e), std::system_category(), "Cannot map " + path);
+		length = static_cast<std::size_t>(sz.QuadPart);
+	}
+	void unmap() noexcept {
+		if (data)
+			UnmapViewOfFile(data);
+		data = nullptr;
+	}
+	/// the file is opened for random access, there is no portable prefetch of a range
+	void advise(std::size_t) noexcept {}
+#else
+	void map(const std::string & path) {
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			const int e = errno;
+			::close(fd);
+			throw std::system_error(e, std::generic_category(), "Cannot open " + path);
+		}
+		length = static_cast<std::size_t>(st.st_size);
+		if (length == 0) {
+			::close(fd);
+			throw std::invalid_argument("Not a packed R-tree file: " + path);
+		}
+		void * p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		const int e = errno;
+		::close(fd);
+		if (p == MAP_FAILED)
+			throw std::system_error(e, std::generic_category(), "Cannot map " + path);
+		data = p;
+	}
+	void unmap() noexcept {
+		if (data)
+			::munmap(data, length);
+		data = nullptr;
+	}
+	/// random access for the items, the root and the levels below it are read ahead while they fit
+	void advise(std::size_t prefetch_bytes) noexcept {
+		::madvise(data, length, MADV_RANDOM);
+		if (levels.size() < 2)
+			return;
+		std::size_t l = levels.size() - 1;
+		while (l > 1 && (levels.back() - levels[l - 2]) * sizeof(rect<T, S>) <= prefetch_bytes)
+			--l;
+		const std::size_t first = sizeof(packed_rtree_header) + static_cast<std::size_t>(levels[l - 1]) * sizeof(rect<T, S>);
+		const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		const std::size_t begin = first / page * page, end = sizeof(packed_rtree_header) + static_cast<std::size_t>(levels.back()) * sizeof(rect<T, S>);
+		::madvise(static_cast<unsigned char *>(data) + begin, end - begin, MADV_WILLNEED);
+	}
+#endif
+
+	void * data = nullptr;
+	std::size_t length = 0;
+	std::size_t node = 0;
+	std::vector<std::uint64_t> levels; /// cumulative box counts per level
+	std::span<const rect<T, S>> all;
+	std::span<const id_type> id_list;
+	std::size_t stack_need = 1;
+};
+
+} //ns geom
+
+#endif //GEOM_PACKED_RTREE_H
@@ -0,0 +1,245 @@
+#ifndef GEOM_QBVH_H
+#define GEOM_QBVH_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_bvh.h"
+
+#include <cmath>
+
+/// BVH with child bounds quantized to 8 or 16 bits per coordinate
+
+namespace geom {
+
+/// same topology and queries as bvh, but each node stores its own bounds as a float frame (origin, step)
+/// and the child bounds as Q codes in it, rounded outwards so queries never miss a rect
+/// with Q = uint8_t child bounds take 4 bytes instead of 16, codes are widened and decoded with SIMD
+/// leaves hold at most 15 rects, rects are tested exactly with their full coordinates
+template <typename T, typename S = T, unsigned W = 4, typename Q = std::uint8_t>
+class quantized_bvh {
+	static_assert(std::is_same_v<Q, std::uint8_t> || std::is_same_v<Q, std::uint16_t>, "quantized_bvh codes are 8 or 16 bit");
+	using vec = simd::vec4<float>;
+	static constexpr float qmax = static_cast<float>(std::numeric_limits<Q>::max());
+public:
+	using id_type = std::uint32_t;
+
+	explicit quantized_bvh(std::span<const std::type_identity_t<rect<T, S>>> rects, bvh_build method = bvh_build::sah, unsigned leaf_size = 4) {
+		bvh<T, S, W> src(rects, method, std::min(leaf_size, 15u));
+		if (rects.size() >= (std::size_t{1} << 27))
+			throw std::length_error("Too many rects for a quantized_bvh");
+		nodes.resize(src.nodes.size());
+		for (std::size_t n = 0; n < nodes.size(); ++n) {
+			const auto & s = src.nodes[n];
+			auto & d = nodes[n];
+			d.lanes = 0;
+			for (unsigned i = 0; i < W; ++i) {
+				if (s.child[i] >= 0) {
+					d.child[i] = s.child[i];
+				} else if (s.count[i] != 0) {
+					const auto first = static_cast<std::uint32_t>(-1 - s.child[i]);
+					d.child[i] = -1 - static_cast<std::int32_t>((first << 4) | s.count[i]);
+				} else {
+					continue;
+				}
+				d.lanes = static_cast<std::uint8_t>(i + 1);
+			}
+		}
+		ids = std::move(src.ids);
+		prims = std::move(src.prims);
+		slot_of = std::move(src.slot_of);
+		stack_need = src.stack_need;
+		refit();
+	}
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return prims.size(); }
+	[[nodiscard]] inline std::size_t node_count() const noexcept { return nodes.size(); }
+	[[nodiscard]] inline std::size_t node_bytes() const noexcept { return nodes.size() * sizeof(node); }
+	[[nodiscard]] inline const rect<T, S> & operator[](id_type id) const { return prims[slot_of.at(id)]; }
+
+	/// moves a rect, node bounds are stale until refit()
+	inline void update(id_type id, const rect<T, S> & r) { prims[slot_of.at(id)] = r; }
+
+	/// recomputes and requantizes all node bounds bottom up, the topology is kept
+	void refit() {
+		std::vector<std::array<T, 4>> exact(nodes.size());
+		std::array<std::array<T, 4>, W> lane;
+		for (std::size_t n = nodes.size(); n-- > 0;) {
+			node & nd = nodes[n];
+			std::array<T, 4> all = empty_bounds();
+			for (unsigned i = 0; i < nd.lanes; ++i) {
+				if (nd.child[i] >= 0) {
+					lane[i] = exact[static_cast<std::size_t>(nd.child[i])];
+				} else {
+					const auto code = static_cast<std::uint32_t>(-1 - nd.child[i]);
+					lane[i] = empty_bounds();
+					for (std::uint32_t k = code >> 4; k < (code >> 4) + (code & 15u); ++k)
+						grow(lane[i], {prims[k].left(), prims[k].top(), prims[k].right(), prims[k].bottom()});
+				}
+				grow(all, lane[i]);
+			}
+			exact[n] = all;
+			set_frame(nd, all);
+			for (unsigned i = 0; i < W; ++i) {
+				if (i < nd.lanes) {
+					nd.x1[i] = encode_lo(float_down(lane[i][0]), nd.ox, nd.sx);
+					nd.y1[i] = encode_lo(float_down(lane[i][1]), nd.oy, nd.sy);
+					nd.x2[i] = encode_hi(float_up(lane[i][2]), nd.ox, nd.sx);
+					nd.y2[i] = encode_hi(float_up(lane[i][3]), nd.oy, nd.sy);
+				} else {
+					nd.x1[i] = nd.y1[i] = nd.x2[i] = nd.y2[i] = 0;
+				}
+			}
+		}
+	}
+
+	/// rects overlapping q with a positive area, f(id, rect)
+	template <typename F>
+	void query(const rect<T, S> & q, F && f) const {
+		/// rounded so the float compares stay conservative for large int coordinates
+		const vec qx1 = vec::splat(float_down(q.left())), qy1 = vec::splat(float_down(q.top()));
+		const vec qx2 = vec::splat(float_up(q.right())), qy2 = vec::splat(float_up(q.bottom()));
+		traverse([&](const node & nd, unsigned g) {
+			const vec ox = vec::splat(nd.ox), oy = vec::splat(nd.oy), sx = vec::splat(nd.sx), sy = vec::splat(nd.sy);
+			return cmple(decode(nd.x1 + 4 * g, ox, sx), qx2) & cmple(qx1, decode(nd.x2 + 4 * g, ox, sx))
+				& cmple(decode(nd.y1 + 4 * g, oy, sy), qy2) & cmple(qy1, decode(nd.y2 + 4 * g, oy, sy));
+		}, [&](const rect<T, S> & r) {
+			return std::max(r.left(), q.left()) < std::min(r.right(), q.right()) && std::max(r.top(), q.top()) < std::min(r.bottom(), q.bottom());
+		}, f);
+	}
+
+	/// rects containing pt (half-open like rect::contains), f(id, rect)
+	template <typename F>
+	void query(const point<T> & pt, F && f) const {
+		const vec px1 = vec::splat(float_down(pt.x)), py1 = vec::splat(float_down(pt.y));
+		const vec px2 = vec::splat(float_up(pt.x)), py2 = vec::splat(float_up(pt.y));
+		traverse([&](const node & nd, unsigned g) {
+			const vec ox = vec::splat(nd.ox), oy = vec::splat(nd.oy), sx = vec::splat(nd.sx), sy = vec::splat(nd.sy);
+			return cmple(decode(nd.x1 + 4 * g, ox, sx), px2) & cmple(px1, decode(nd.x2 + 4 * g, ox, sx))
+				& cmple(decode(nd.y1 + 4 * g, oy, sy), py2) & cmple(py1, decode(nd.y2 + 4 * g, oy, sy));
+		}, [&](const rect<T, S> & r) { return r.contains(pt); }, f);
+	}
+
+private:
+	/// child[i] >= 0 is an inner node, otherwise -1 - child[i] is (first prim << 4 | count)
+	/// lanes [0, lanes) are used, coordinate = origin + code * step
+	struct node {
+		float ox, oy, sx, sy;
+		Q x1[W], y1[W], x2[W], y2[W];
+		std::int32_t child[W];
+		std::uint8_t lanes;
+	};
+
+	[[nodiscard]] static inline vec load_codes(const Q * p) noexcept {
+		if constexpr (std::is_same_v<Q, std::uint8_t>)
+			return vec::load_u8(p);
+		else
+			return vec::load_u16(p);
+	}
+	[[nodiscard]] static inline vec decode(const Q * p, vec o, vec s) noexcept { return o + load_codes(p) * s; }
+	/// scalar decode through the same vector operations, so encoding sees the rounding queries see
+	[[nodiscard]] static inline float decode(float code, float o, float s) noexcept {
+		return (vec::splat(o) + vec::splat(code) * vec::splat(s)).lanes()[0];
+	}
+
+	[[nodiscard]] static inline float float_down(T v) noexcept {
+		const auto f = static_cast<float>(v);
+		if constexpr (std::is_integral_v<T>)
+			return static_cast<double>(f) > static_cast<double>(v) ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+		else
+			return f;
+	}
+	[[nodiscard]] static inline float float_up(T v) noexcept {
+		const auto f = static_cast<float>(v);
+		if constexpr (std::is_integral_v<T>)
+			return static_cast<double>(f) < static_cast<double>(v) ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+		else
+			return f;
+	}
+
+	[[nodiscard]] static inline std::array<T, 4> empty_bounds() noexcept {
+		return {std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()};
+	}
+	static inline void grow(std::array<T, 4> & b, const std::array<T, 4> & r) noexcept {
+		b[0] = std::min(b[0], r[0]); b[1] = std::min(b[1], r[1]);
+		b[2] = std::max(b[2], r[2]); b[3] = std::max(b[3], r[3]);
+	}
+
+	/// frame covering b, the step is nudged up until the last code reaches the far edge
+	static void set_frame(node & nd, const std::array<T, 4> & b) noexcept {
+		const auto axis = [](float lo, float hi, float & o, float & s) {
+			o = lo;
+			s = hi > lo ? (hi - lo) / qmax : 0.f;
+			while (decode(qmax, o, s) < hi)
+				s = std::nextafter(s, std::numeric_limits<float>::infinity());
+		};
+		axis(float_down(b[0]), float_up(b[2]), nd.ox, nd.sx);
+		axis(float_down(b[1]), float_up(b[3]), nd.oy, nd.sy);
+	}
+
+	/// largest code decoding at or below v
+	[[nodiscard]] static Q encode_lo(float v, float o, float s) noexcept {
+		float c = s > 0.f ? std::clamp(std::floor((v - o) / s), 0.f, qmax) : 0.f;
+		while (c > 0.f && decode(c, o, s) > v)
+			c -= 1.f;
+		return static_cast<Q>(c);
+	}
+	/// smallest code decoding at or above v
+	[[nodiscard]] static Q encode_hi(float v, float o, float s) noexcept {
+		float c = s > 0.f ? std::clamp(std::ceil((v - o) / s), 0.f, qmax) : 0.f;
+		while (c < qmax && decode(c, o, s) < v)
+			c += 1.f;
+		return static_cast<Q>(c);
+	}
+
+	template <typename Test, typename Prim, typename F>
+	void traverse(Test && test, Prim && prim, F && f) const {
+		if (nodes.empty())
+			return;
+		constexpr std::size_t fixed_stack = 256;
+		std::uint32_t fixed[fixed_stack];
+		std::vector<std::uint32_t> heap;
+		std::uint32_t * stack = fixed;
+		if (stack_need > fixed_stack) {
+			heap.resize(stack_need);
+			stack = heap.data();
+		}
+		std::size_t sp = 0;
+		stack[sp++] = 0;
+		while (sp != 0) {
+			const node & nd = nodes[stack[--sp]];
+			unsigned mask = 0;
+			for (unsigned g = 0; g < W / 4; ++g)
+				mask |= test(nd, g) << (4 * g);
+			for (mask &= (1u << nd.lanes) - 1u; mask != 0; mask &= mask - 1) {
+				const auto i = static_cast<unsigned>(std::countr_zero(mask));
+				if (nd.child[i] >= 0) {
+					stack[sp++] = static_cast<std::uint32_t>(nd.child[i]);
+					continue;
+				}
+				const auto code = static_cast<std::uint32_t>(-1 - nd.child[i]);
+				for (std::uint32_t k = code >> 4; k < (code >> 4) + (code & 15u); ++k) {
+					if (!prim(prims[k]))
+						continue;
+					if constexpr (std::is_same_v<std::invoke_result_t<F &, id_type, const rect<T, S> &>, bool>) {
+						if (!f(ids[k], prims[k]))
+							return;
+					} else {
+						f(ids[k], prims[k]);
+					}
+				}
+			}
+		}
+	}
+
+	std::size_t stack_need = 1;
+	std::vector<node> nodes;
+	std::vector<id_type> ids; /// prim slot -> id
+	std::vector<rect<T, S>> prims; /// rects in leaf order
+	std::vector<std::uint32_t> slot_of; /// id -> prim slot
+};
+
+} //ns geom
+
+#endif //GEOM_QBVH_H
@@ -0,0 +1,68 @@
+#ifndef GEOM_RANGES_H
+#define GEOM_RANGES_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <ranges>
+
+/// lazy range adaptors over rects, chained adaptors run as one pass without intermediate vectors
+/// usage: std::ranges::copy(rects | geom::views::translated(dx, dy) | geom::views::clipped(clip), std::back_inserter(out))
+
+namespace geom::views {
+
+template <typename T>
+[[nodiscard]] inline constexpr auto translated(T dx, T dy) {
+	return std::views::transform([dx, dy](const auto & r) { return r.translated(dx, dy); });
+}
+
+template <typename T>
+[[nodiscard]] inline constexpr auto translated(point<T> dt) { return translated(dt.x, dt.y); }
+
+template <typename T>
+[[nodiscard]] inline constexpr auto expanded(T d) {
+	return std::views::transform([d](const auto & r) { return r.expanded(d); });
+}
+
+/// intersections with clip, rects not overlapping clip are dropped
+/// like std::views::filter, transforms before it run again when a kept rect is read
+template <typename T, typename S>
+[[nodiscard]] inline constexpr auto clipped(const rect<T, S> & clip) {
+	return std::views::transform([clip](const rect<T, S> & r) { return intersect_raw(r, clip); })
+		| std::views::filter([](const raw_intersection<T, S> & i) { return i.valid; })
+		| std::views::transform([](const raw_intersection<T, S> & i) { return i.r; });
+}
+
+template <typename T2, typename S2 = T2>
+inline constexpr auto cast = std::views::transform([](const auto & r) { return r.template cast<T2, S2>(); });
+
+/// rectf to integer rect with rounded edges, adjacent rects stay adjacent
+template <typename T2 = int, typename S2 = T2>
+inline constexpr auto rounded = std::views::transform([](const rectf & r) {
+	return rect<T2, S2>(static_cast<T2>(std::lround(r.left())), static_cast<T2>(std::lround(r.top())),
+		static_cast<T2>(std::lround(r.right())), static_cast<T2>(std::lround(r.bottom())));
+});
+
+} //ns geom::views
+
+
+namespace geom {
+
+/// in-place batch versions for contiguous storage
+
+template <typename T, typename S>
+inline void translate_all(std::span<rect<T, S>> rects, T dx, T dy) noexcept {
+	for (auto & r : rects)
+		r.translate(dx, dy);
+}
+
+template <typename T, typename S>
+inline void expand_all(std::span<rect<T, S>> rects, T d) noexcept {
+	for (auto & r : rects)
+		r = r.expanded(d);
+}
+
+} //ns geom
+
+#endif //GEOM_RANGES_H
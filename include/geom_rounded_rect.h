@@ -0,0 +1,217 @@
+#ifndef GEOM_ROUNDED_RECT_H
+#define GEOM_ROUNDED_RECT_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include "geom_simd.h"
+
+#include <cmath>
+
+/// rect with rounded corners, exact hit testing and signed distance
+
+namespace geom {
+
+template <typename T>
+struct corner_radii {
+	using value_type = T;
+	T top_left, top_right, bottom_right, bottom_left;
+
+	[[nodiscard]] static constexpr inline corner_radii uniform(T r) noexcept { return corner_radii{r, r, r, r}; }
+	[[nodiscard]] friend inline constexpr bool operator==(const corner_radii &, const corner_radii &) = default;
+};
+
+namespace detail {
+
+/// Newton iteration during constant evaluation, std::sqrt otherwise
+[[nodiscard]] inline constexpr float sqrt_c(float v) noexcept {
+	if (!std::is_constant_evaluated())
+		return std::sqrt(v);
+	if (!(v > 0.f))
+		return 0.f;
+	double x = v > 1.f ? static_cast<double>(v) : 1.0;
+	for (int i = 0; i < 64; ++i) {
+		const double n = 0.5 * (x + static_cast<double>(v) / x);
+		if (n == x)
+			break;
+		x = n;
+	}
+	return static_cast<float>(x);
+}
+
+/// signed distance of a point relative to the box center to a box with half size (hx, hy)
+/// and corner radius r of the point's quadrant, negative inside
+[[nodiscard]] inline constexpr float rounded_box_sdf(float px, float py, float hx, float hy, float r) noexcept {
+	const float qx = (px < 0.f ? -px : px) - hx + r;
+	const float qy = (py < 0.f ? -py : py) - hy + r;
+	const float ox = qx > 0.f ? qx : 0.f, oy = qy > 0.f ? qy : 0.f;
+	const float in = qx > qy ? qx : qy;
+	return (in < 0.f ? in : 0.f) + sqrt_c(ox * ox + oy * oy) - r;
+}
+
+[[nodiscard]] inline simd::vec4<float> rounded_box_sdf(simd::vec4<float> px, simd::vec4<float> py,
+	simd::vec4<float> hx, simd::vec4<float> hy, simd::vec4<float> r) noexcept
+{
+	using vec = simd::vec4<float>;
+	const vec zero = vec::splat(0.f);
+	const vec qx = abs(px) - hx + r, qy = abs(py) - hy + r;
+	const vec ox = max(qx, zero), oy = max(qy, zero);
+	return min(max(qx, qy), zero) + sqrt(ox * ox + oy * oy) - r;
+}
+
+/// radius of the corner in the quadrant of (px, py), y grows downwards
+[[nodiscard]] inline simd::vec4<float> quadrant_radius(simd::vec4<float> px, simd::vec4<float> py,
+	simd::vec4<float> tl, simd::vec4<float> tr, simd::vec4<float> br, simd::vec4<float> bl) noexcept
+{
+	const auto zero = simd::vec4<float>::splat(0.f);
+	return select_lt(px, zero, select_lt(py, zero, tl, bl), select_lt(py, zero, tr, br));
+}
+
+} //ns detail
+
+/// radii are clamped to be non-negative and scaled down together (as in CSS) when adjacent ones overlap
+template <typename T, typename S = T>
+class rounded_rect {
+public:
+	using value_type = T;
+
+	constexpr rounded_rect(const rect<T, S> & bounds, const corner_radii<T> & radii) noexcept : r(bounds), rad(radii) { normalize(); }
+	constexpr rounded_rect(const rect<T, S> & bounds, T radius) noexcept : rounded_rect(bounds, corner_radii<T>::uniform(radius)) {}
+
+	[[nodiscard]] inline constexpr const rect<T, S> & bounds() const noexcept { return r; }
+	[[nodiscard]] inline constexpr const corner_radii<T> & radii() const noexcept { return rad; }
+
+	/// half-open like rect::contains, corner arcs are inclusive
+	[[nodiscard]] inline constexpr bool contains(T x, T y) const noexcept {
+		if (!(r.left() <= x && x < r.right() && r.top() <= y && y < r.bottom()))
+			return false;
+		if (x < r.left() + rad.top_left && y < r.top() + rad.top_left)
+			return in_circle(r.left() + rad.top_left - x, r.top() + rad.top_left - y, rad.top_left);
+		if (x >= r.right() - rad.top_right && y < r.top() + rad.top_right)
+			return in_circle(x - (r.right() - rad.top_right), r.top() + rad.top_right - y, rad.top_right);
+		if (x >= r.right() - rad.bottom_right && y >= r.bottom() - rad.bottom_right)
+			return in_circle(x - (r.right() - rad.bottom_right), y - (r.bottom() - rad.bottom_right), rad.bottom_right);
+		if (x < r.left() + rad.bottom_left && y >= r.bottom() - rad.bottom_left)
+			return in_circle(r.left() + rad.bottom_left - x, y - (r.bottom() - rad.bottom_left), rad.bottom_left);
+		return true;
+	}
+	[[nodiscard]] inline constexpr bool contains(const point<T> & pt) const noexcept { return contains(pt.x, pt.y); }
+
+	/// signed distance to the outline, negative inside, using the radius of the point's quadrant
+	/// exact while no radius exceeds half the shorter side, an approximation near larger corners otherwise
+	[[nodiscard]] inline constexpr float signed_distance(float x, float y) const noexcept {
+		const float cx = (static_cast<float>(r.left()) + static_cast<float>(r.right())) * 0.5f;
+		const float cy = (static_cast<float>(r.top()) + static_cast<float>(r.bottom())) * 0.5f;
+		const float px = x - cx, py = y - cy;
+		const T q = px < 0.f ? (py < 0.f ? rad.top_left : rad.bottom_left) : (py < 0.f ? rad.top_right : rad.bottom_right);
+		const float hx = static_cast<float>(r.width()) * 0.5f;
+		const float hy = (static_cast<float>(r.bottom()) - static_cast<float>(r.top())) * 0.5f;
+		return detail::rounded_box_sdf(px, py, hx, hy, static_cast<float>(q));
+	}
+	[[nodiscard]] inline constexpr float signed_distance(const point<T> & pt) const noexcept {
+		return signed_distance(static_cast<float>(pt.x), static_cast<float>(pt.y));
+	}
+
+	[[nodiscard]] friend inline constexpr bool operator==(const rounded_rect &, const rounded_rect &) = default;
+
+private:
+	using wide = std::conditional_t<std::is_integral_v<T>, std::int64_t, T>;
+
+	[[nodiscard]] static inline constexpr bool in_circle(T dx, T dy, T radius) noexcept {
+		const wide x = dx, y = dy, q = radius;
+		return x * x + y * y <= q * q;
+	}
+
+	constexpr void normalize() noexcept {
+		for (T * v : {&rad.top_left, &rad.top_right, &rad.bottom_right, &rad.bottom_left})
+			*v = *v < T{} ? T{} : *v;
+		/// rect::height() is not constexpr
+		const auto w = static_cast<double>(r.right()) - static_cast<double>(r.left());
+		const auto h = static_cast<double>(r.bottom()) - static_cast<double>(r.top());
+		double f = 1.0;
+		const auto fit = [&f](double extent, T a, T b) {
+			const double sum = static_cast<double>(a) + static_cast<double>(b);
+			if (sum > extent)
+				f = std::min(f, extent > 0.0 ? extent / sum : 0.0);
+		};
+		fit(w, rad.top_left, rad.top_right);
+		fit(w, rad.bottom_left, rad.bottom_right);
+		fit(h, rad.top_left, rad.bottom_left);
+		fit(h, rad.top_right, rad.bottom_right);
+		if (f < 1.0) {
+			for (T * v : {&rad.top_left, &rad.top_right, &rad.bottom_right, &rad.bottom_left})
+				*v = static_cast<T>(static_cast<double>(*v) * f);
+		}
+	}
+
+	rect<T, S> r;
+	corner_radii<T> rad;
+};
+
+using rounded_recti = rounded_rect<int>;
+using rounded_rectf = rounded_rect<float>;
+
+
+/// bulk signed distances of many points to one rounded rect, 4 points per step
+inline void signed_distance(const rounded_rectf & rr, std::span<const pointf> pts, std::span<float> out) {
+	if (out.size() < pts.size())
+		throw std::out_of_range("Output span is shorter than the point span");
+	using vec = simd::vec4<float>;
+	const auto & b = rr.bounds();
+	const auto & q = rr.radii();
+	const float cx = (b.left() + b.right()) * 0.5f, cy = (b.top() + b.bottom()) * 0.5f;
+	const vec vcx = vec::splat(cx), vcy = vec::splat(cy);
+	const vec hx = vec::splat(b.width() * 0.5f), hy = vec::splat(b.height() * 0.5f);
+	const vec tl = vec::splat(q.top_left), tr = vec::splat(q.top_right), br = vec::splat(q.bottom_right), bl = vec::splat(q.bottom_left);
+	std::size_t i = 0;
+	for (; i + 4 <= pts.size(); i += 4) {
+		const vec px = vec::set(pts[i].x, pts[i + 1].x, pts[i + 2].x, pts[i + 3].x) - vcx;
+		const vec py = vec::set(pts[i].y, pts[i + 1].y, pts[i + 2].y, pts[i + 3].y) - vcy;
+		detail::rounded_box_sdf(px, py, hx, hy, detail::quadrant_radius(px, py, tl, tr, br, bl)).store(out.data() + i);
+	}
+	for (; i < pts.size(); ++i)
+		out[i] = rr.signed_distance(pts[i]);
+}
+
+/// bulk signed distances of one point to many rounded rects, 4 rects per step
+inline void signed_distance(const pointf & pt, std::span<const rounded_rectf> rrs, std::span<float> out) {
+	if (out.size() < rrs.size())
+		throw std::out_of_range("Output span is shorter than the rounded rect span");
+	using vec = simd::vec4<float>;
+	const vec x = vec::splat(pt.x), y = vec::splat(pt.y), half = vec::splat(0.5f);
+	std::size_t i = 0;
+	for (; i + 4 <= rrs.size(); i += 4) {
+		const auto lane = [&](auto f) { return vec::set(f(rrs[i]), f(rrs[i + 1]), f(rrs[i + 2]), f(rrs[i + 3])); };
+		const vec x1 = lane([](const rounded_rectf & r) { return r.bounds().left(); });
+		const vec y1 = lane([](const rounded_rectf & r) { return r.bounds().top(); });
+		const vec x2 = lane([](const rounded_rectf & r) { return r.bounds().right(); });
+		const vec y2 = lane([](const rounded_rectf & r) { return r.bounds().bottom(); });
+		const vec px = x - (x1 + x2) * half, py = y - (y1 + y2) * half;
+		const vec r = detail::quadrant_radius(px, py,
+			lane([](const rounded_rectf & r) { return r.radii().top_left; }),
+			lane([](const rounded_rectf & r) { return r.radii().top_right; }),
+			lane([](const rounded_rectf & r) { return r.radii().bottom_right; }),
+			lane([](const rounded_rectf & r) { return r.radii().bottom_left; }));
+		detail::rounded_box_sdf(px, py, (x2 - x1) * half, (y2 - y1) * half, r).store(out.data() + i);
+	}
+	for (; i < rrs.size(); ++i)
+		out[i] = rrs[i].signed_distance(pt);
+}
+
+/// anti-aliased pixel coverage from a signed distance in pixels, 0 outside, 1 inside
+[[nodiscard]] inline constexpr float coverage(float signed_distance) noexcept {
+	const float c = 0.5f - signed_distance;
+	return c < 0.f ? 0.f : (c > 1.f ? 1.f : c);
+}
+
+/// bulk coverage of pixel centers against one rounded rect, computed in place over the distances
+inline void coverage(const rounded_rectf & rr, std::span<const pointf> pts, std::span<float> out) {
+	signed_distance(rr, pts, out);
+	for (std::size_t i = 0; i < pts.size(); ++i)
+		out[i] = coverage(out[i]);
+}
+
+} //ns geom
+
+#endif //GEOM_ROUNDED_RECT_H
@@ -0,0 +1,300 @@
+#ifndef GEOM_SIMD_H
+#define GEOM_SIMD_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+/// define GEOM_NO_SIMD to force the portable scalar fallback
+#if !defined GEOM_NO_SIMD && (defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+#define GEOM_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined __SSE4_1__
+#include <smmintrin.h> /// for _mm_min_epi32
+#endif
+#elif !defined GEOM_NO_SIMD && (defined __aarch64__ || defined _M_ARM64)
+#define GEOM_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring> /// for memcpy
+
+/// 128-bit packed rect representation
+
+namespace geom::simd {
+
+/// four int or float lanes held in one 128-bit register
+/// comparisons return a bitmask, bit i is set when lane i compares true
+template <typename T>
+struct vec4;
+
+#if defined GEOM_SIMD_SSE2
+
+template <>
+struct vec4<int> {
+	__m128i r;
+
+	[[nodiscard]] static inline vec4 set(int a, int b, int c, int d) noexcept { return {_mm_setr_epi32(a, b, c, d)}; }
+	[[nodiscard]] static inline vec4 splat(int a) noexcept { return {_mm_set1_epi32(a)}; }
+	[[nodiscard]] static inline vec4 load(const int * p) noexcept { return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))}; }
+	inline void store(int * p) const noexcept { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), r); }
+	[[nodiscard]] inline std::array<int, 4> lanes() const noexcept { std::array<int, 4> l; store(l.data()); return l; }
+	[[nodiscard]] friend inline vec4 operator+(vec4 a, vec4 b) noexcept { return {_mm_add_epi32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator-(vec4 a, vec4 b) noexcept { return {_mm_sub_epi32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 min(vec4 a, vec4 b) noexcept {
+#if defined __SSE4_1__
+		return {_mm_min_epi32(a.r, b.r)};
+#else
+		const __m128i gt = _mm_cmpgt_epi32(a.r, b.r);
+		return {_mm_or_si128(_mm_and_si128(gt, b.r), _mm_andnot_si128(gt, a.r))};
+#endif
+	}
+	[[nodiscard]] friend inline vec4 max(vec4 a, vec4 b) noexcept {
+#if defined __SSE4_1__
+		return {_mm_max_epi32(a.r, b.r)};
+#else
+		const __m128i gt = _mm_cmpgt_epi32(a.r, b.r);
+		return {_mm_or_si128(_mm_and_si128(gt, a.r), _mm_andnot_si128(gt, b.r))};
+#endif
+	}
+	/// {a0, a1, b2, b3}
+	[[nodiscard]] friend inline vec4 lo_hi(vec4 a, vec4 b) noexcept {
+		return {_mm_castpd_si128(_mm_move_sd(_mm_castsi128_pd(b.r), _mm_castsi128_pd(a.r)))};
+	}
+	/// {a2, a3, a0, a1}
+	[[nodiscard]] friend inline vec4 swap_halves(vec4 a) noexcept { return {_mm_shuffle_epi32(a.r, _MM_SHUFFLE(1, 0, 3, 2))}; }
+	[[nodiscard]] friend inline unsigned cmplt(vec4 a, vec4 b) noexcept { return mask(_mm_cmplt_epi32(a.r, b.r)); }
+	[[nodiscard]] friend inline unsigned cmple(vec4 a, vec4 b) noexcept { return ~mask(_mm_cmpgt_epi32(a.r, b.r)) & 0xfu; }
+	[[nodiscard]] friend inline unsigned cmpeq(vec4 a, vec4 b) noexcept { return mask(_mm_cmpeq_epi32(a.r, b.r)); }
+
+private:
+	[[nodiscard]] static inline unsigned mask(__m128i m) noexcept { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m))); }
+};
+
+template <>
+struct vec4<float> {
+	__m128 r;
+
+	[[nodiscard]] static inline vec4 set(float a, float b, float c, float d) noexcept { return {_mm_setr_ps(a, b, c, d)}; }
+	[[nodiscard]] static inline vec4 splat(float a) noexcept { return {_mm_set1_ps(a)}; }
+	[[nodiscard]] static inline vec4 load(const float * p) noexcept { return {_mm_loadu_ps(p)}; }
+	/// 4 unsigned 8 or 16 bit integers converted to float lanes
+	[[nodiscard]] static inline vec4 load_u8(const std::uint8_t * p) noexcept {
+		std::int32_t v;
+		std::memcpy(&v, p, 4);
+		const __m128i z = _mm_setzero_si128();
+		return {_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), z), z))};
+	}
+	[[nodiscard]] static inline vec4 load_u16(const std::uint16_t * p) noexcept {
+		const __m128i z = _mm_setzero_si128();
+		return {_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), z))};
+	}
+	inline void store(float * p) const noexcept { _mm_storeu_ps(p, r); }
+	[[nodiscard]] inline std::array<float, 4> lanes() const noexcept { std::array<float, 4> l; store(l.data()); return l; }
+	[[nodiscard]] friend inline vec4 operator+(vec4 a, vec4 b) noexcept { return {_mm_add_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator-(vec4 a, vec4 b) noexcept { return {_mm_sub_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator*(vec4 a, vec4 b) noexcept { return {_mm_mul_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator/(vec4 a, vec4 b) noexcept { return {_mm_div_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 min(vec4 a, vec4 b) noexcept { return {_mm_min_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 max(vec4 a, vec4 b) noexcept { return {_mm_max_ps(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 lo_hi(vec4 a, vec4 b) noexcept { return {_mm_shuffle_ps(a.r, b.r, _MM_SHUFFLE(3, 2, 1, 0))}; }
+	[[nodiscard]] friend inline vec4 swap_halves(vec4 a) noexcept { return {_mm_shuffle_ps(a.r, a.r, _MM_SHUFFLE(1, 0, 3, 2))}; }
+	[[nodiscard]] friend inline unsigned cmplt(vec4 a, vec4 b) noexcept { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(a.r, b.r))); }
+	[[nodiscard]] friend inline unsigned cmple(vec4 a, vec4 b) noexcept { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(a.r, b.r))); }
+	[[nodiscard]] friend inline unsigned cmpeq(vec4 a, vec4 b) noexcept { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(a.r, b.r))); }
+	[[nodiscard]] friend inline vec4 sqrt(vec4 a) noexcept { return {_mm_sqrt_ps(a.r)}; }
+	[[nodiscard]] friend inline vec4 abs(vec4 a) noexcept { return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.r)}; }
+	/// per lane a < b ? x : y
+	[[nodiscard]] friend inline vec4 select_lt(vec4 a, vec4 b, vec4 x, vec4 y) noexcept {
+		const __m128 m = _mm_cmplt_ps(a.r, b.r);
+		return {_mm_or_ps(_mm_and_ps(m, x.r), _mm_andnot_ps(m, y.r))};
+	}
+};
+
+#elif defined GEOM_SIMD_NEON
+
+namespace detail {
+[[nodiscard]] inline unsigned movemask(uint32x4_t m) noexcept {
+	static const uint32_t bits[4] = {1u, 2u, 4u, 8u};
+	return vaddvq_u32(vandq_u32(m, vld1q_u32(bits)));
+}
+} //ns detail
+
+template <>
+struct vec4<int> {
+	int32x4_t r;
+
+	[[nodiscard]] static inline vec4 set(int a, int b, int c, int d) noexcept { const int l[4] = {a, b, c, d}; return {vld1q_s32(l)}; }
+	[[nodiscard]] static inline vec4 splat(int a) noexcept { return {vdupq_n_s32(a)}; }
+	[[nodiscard]] static inline vec4 load(const int * p) noexcept { return {vld1q_s32(p)}; }
+	inline void store(int * p) const noexcept { vst1q_s32(p, r); }
+	[[nodiscard]] inline std::array<int, 4> lanes() const noexcept { std::array<int, 4> l; store(l.data()); return l; }
+	[[nodiscard]] friend inline vec4 operator+(vec4 a, vec4 b) noexcept { return {vaddq_s32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator-(vec4 a, vec4 b) noexcept { return {vsubq_s32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 min(vec4 a, vec4 b) noexcept { return {vminq_s32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 max(vec4 a, vec4 b) noexcept { return {vmaxq_s32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 lo_hi(vec4 a, vec4 b) noexcept { return {vcombine_s32(vget_low_s32(a.r), vget_high_s32(b.r))}; }
+	[[nodiscard]] friend inline vec4 swap_halves(vec4 a) noexcept { return {vextq_s32(a.r, a.r, 2)}; }
+	[[nodiscard]] friend inline unsigned cmplt(vec4 a, vec4 b) noexcept { return detail::movemask(vcltq_s32(a.r, b.r)); }
+	[[nodiscard]] friend inline unsigned cmple(vec4 a, vec4 b) noexcept { return detail::movemask(vcleq_s32(a.r, b.r)); }
+	[[nodiscard]] friend inline unsigned cmpeq(vec4 a, vec4 b) noexcept { return detail::movemask(vceqq_s32(a.r, b.r)); }
+};
+
+template <>
+struct vec4<float> {
+	float32x4_t r;
+
+	[[nodiscard]] static inline vec4 set(float a, float b, float c, float d) noexcept { const float l[4] = {a, b, c, d}; return {vld1q_f32(l)}; }
+	[[nodiscard]] static inline vec4 splat(float a) noexcept { return {vdupq_n_f32(a)}; }
+	[[nodiscard]] static inline vec4 load(const float * p) noexcept { return {vld1q_f32(p)}; }
+	/// 4 unsigned 8 or 16 bit integers converted to float lanes
+	[[nodiscard]] static inline vec4 load_u8(const std::uint8_t * p) noexcept {
+		std::uint32_t v;
+		std::memcpy(&v, p, 4);
+		return {vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(v)))))};
+	}
+	[[nodiscard]] static inline vec4 load_u16(const std::uint16_t * p) noexcept { return {vcvtq_f32_u32(vmovl_u16(vld1_u16(p)))}; }
+	inline void store(float * p) const noexcept { vst1q_f32(p, r); }
+	[[nodiscard]] inline std::array<float, 4> lanes() const noexcept { std::array<float, 4> l; store(l.data()); return l; }
+	[[nodiscard]] friend inline vec4 operator+(vec4 a, vec4 b) noexcept { return {vaddq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator-(vec4 a, vec4 b) noexcept { return {vsubq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator*(vec4 a, vec4 b) noexcept { return {vmulq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 operator/(vec4 a, vec4 b) noexcept { return {vdivq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 min(vec4 a, vec4 b) noexcept { return {vminq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 max(vec4 a, vec4 b) noexcept { return {vmaxq_f32(a.r, b.r)}; }
+	[[nodiscard]] friend inline vec4 lo_hi(vec4 a, vec4 b) noexcept { return {vcombine_f32(vget_low_f32(a.r), vget_high_f32(b.r))}; }
+	[[nodiscard]] friend inline vec4 swap_halves(vec4 a) noexcept { return {vextq_f32(a.r, a.r, 2)}; }
+	[[nodiscard]] friend inline unsigned cmplt(vec4 a, vec4 b) noexcept { return detail::movemask(vcltq_f32(a.r, b.r)); }
+	[[nodiscard]] friend inline unsigned cmple(vec4 a, vec4 b) noexcept { return detail::movemask(vcleq_f32(a.r, b.r)); }
+	[[nodiscard]] friend inline unsigned cmpeq(vec4 a, vec4 b) noexcept { return detail::movemask(vceqq_f32(a.r, b.r)); }
+	[[nodiscard]] friend inline vec4 sqrt(vec4 a) noexcept { return {vsqrtq_f32(a.r)}; }
+	[[nodiscard]] friend inline vec4 abs(vec4 a) noexcept { return {vabsq_f32(a.r)}; }
+	/// per lane a < b ? x : y
+	[[nodiscard]] friend inline vec4 select_lt(vec4 a, vec4 b, vec4 x, vec4 y) noexcept { return {vbslq_f32(vcltq_f32(a.r, b.r), x.r, y.r)}; }
+};
+
+#else
+
+/// portable fallback, still written lane-wise so the compiler may vectorize it
+template <typename T>
+struct vec4 {
+	std::array<T, 4> r;
+
+	[[nodiscard]] static constexpr inline vec4 set(T a, T b, T c, T d) noexcept { return {{a, b, c, d}}; }
+	[[nodiscard]] static constexpr inline vec4 splat(T a) noexcept { return {{a, a, a, a}}; }
+	[[nodiscard]] static constexpr inline vec4 load(const T * p) noexcept { return {{p[0], p[1], p[2], p[3]}}; }
+	/// 4 unsigned 8 or 16 bit integers converted to float lanes
+	[[nodiscard]] static constexpr inline vec4 load_u8(const std::uint8_t * p) noexcept { return {{T(p[0]), T(p[1]), T(p[2]), T(p[3])}}; }
+	[[nodiscard]] static constexpr inline vec4 load_u16(const std::uint16_t * p) noexcept { return {{T(p[0]), T(p[1]), T(p[2]), T(p[3])}}; }
+	constexpr inline void store(T * p) const noexcept { for (int i = 0; i < 4; ++i) p[i] = r[i]; }
+	[[nodiscard]] constexpr inline std::array<T, 4> lanes() const noexcept { return r; }
+	[[nodiscard]] friend constexpr inline vec4 operator+(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] += b.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 operator-(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] -= b.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 operator*(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] *= b.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 operator/(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] /= b.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 min(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] = b.r[i] < a.r[i] ? b.r[i] : a.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 max(vec4 a, vec4 b) noexcept { for (int i = 0; i < 4; ++i) a.r[i] = a.r[i] < b.r[i] ? b.r[i] : a.r[i]; return a; }
+	[[nodiscard]] friend constexpr inline vec4 lo_hi(vec4 a, vec4 b) noexcept { return {{a.r[0], a.r[1], b.r[2], b.r[3]}}; }
+	[[nodiscard]] friend constexpr inline vec4 swap_halves(vec4 a) noexcept { return {{a.r[2], a.r[3], a.r[0], a.r[1]}}; }
+	[[nodiscard]] friend constexpr inline unsigned cmplt(vec4 a, vec4 b) noexcept { unsigned m = 0; for (int i = 0; i < 4; ++i) m |= unsigned{a.r[i] < b.r[i]} << i; return m; }
+	[[nodiscard]] friend constexpr inline unsigned cmple(vec4 a, vec4 b) noexcept { unsigned m = 0; for (int i = 0; i < 4; ++i) m |= unsigned{a.r[i] <= b.r[i]} << i; return m; }
+	[[nodiscard]] friend constexpr inline unsigned cmpeq(vec4 a, vec4 b) noexcept { unsigned m = 0; for (int i = 0; i < 4; ++i) m |= unsigned{a.r[i] == b.r[i]} << i; return m; }
+	/// float lanes only
+	[[nodiscard]] friend inline vec4 sqrt(vec4 a) noexcept { for (int i = 0; i < 4; ++i) a.r[i] = std::sqrt(a.r[i]); return a; }
+	[[nodiscard]] friend constexpr inline vec4 abs(vec4 a) noexcept { for (int i = 0; i < 4; ++i) a.r[i] = a.r[i] < T{} ? -a.r[i] : a.r[i]; return a; }
+	/// per lane a < b ? x : y
+	[[nodiscard]] friend constexpr inline vec4 select_lt(vec4 a, vec4 b, vec4 x, vec4 y) noexcept { for (int i = 0; i < 4; ++i) x.r[i] = a.r[i] < b.r[i] ? x.r[i] : y.r[i]; return x; }
+};
+
+#endif
+
+} //ns geom::simd
+
+
+namespace geom {
+
+/// rect held in a single 128-bit register as {x1, y1, x2, y2}
+/// opt-in companion of rect<int, S> / rect<float>, convert at loop boundaries
+/// intersected() does not return optional, the result may be inverted, check it with valid()
+template <typename T>
+class packed_rect {
+	static_assert(std::is_same_v<T, int> || std::is_same_v<T, float>, "packed_rect supports int and float only");
+	using vec = simd::vec4<T>;
+public:
+	using value_type = T;
+	explicit packed_rect(vec v) noexcept : v(v) {}
+	packed_rect(T x1, T y1, T x2, T y2) noexcept : v(vec::set(x1, y1, x2, y2)) {}
+	template <typename S>
+	explicit packed_rect(const rect<T, S> & r) noexcept : v(vec::set(r.left(), r.top(), r.right(), r.bottom())) {}
+
+	/// throws like rect constructor does for an inverted unsigned-sized rect
+	template <typename S = T>
+	[[nodiscard]] inline rect<T, S> to_rect() const {
+		const auto l = v.lanes();
+		return rect<T, S>(l[0], l[1], l[2], l[3]);
+	}
+	[[nodiscard]] inline vec data() const noexcept { return v; }
+
+	[[nodiscard]] inline T left() const noexcept { return v.lanes()[0]; }
+	[[nodiscard]] inline T top() const noexcept { return v.lanes()[1]; }
+	[[nodiscard]] inline T right() const noexcept { return v.lanes()[2]; }
+	[[nodiscard]] inline T bottom() const noexcept { return v.lanes()[3]; }
+	[[nodiscard]] inline geom::size<T> size() const noexcept {
+		const auto d = (v - swap_halves(v)).lanes();
+		return geom::size<T>{ d[2], d[3] };
+	}
+	[[nodiscard]] inline T width() const noexcept { return size().width; }
+	[[nodiscard]] inline T height() const noexcept { return size().height; }
+
+	/// same meaning as rect::empty
+	[[nodiscard]] inline bool empty() const noexcept { return (cmpeq(v, swap_halves(v)) & 0x3u) != 0; }
+	/// positive width and height, false for an inverted intersected() result
+	/// for non-empty operands matches rect::intersected().has_value()
+	[[nodiscard]] inline bool valid() const noexcept { return (cmplt(v, swap_halves(v)) & 0x3u) == 0x3u; }
+
+	[[nodiscard]] inline bool contains(T x, T y) const noexcept {
+		const auto p = vec::set(x, y, x, y);
+		return ((cmple(v, p) & 0x3u) | (cmplt(p, v) & 0xcu)) == 0xfu;
+	}
+	[[nodiscard]] inline bool contains(const point<T> & pt) const noexcept { return contains(pt.x, pt.y); }
+	[[nodiscard]] inline bool contains(const packed_rect & inner) const noexcept {
+		return ((cmplt(inner.v, v) & 0x3u) | (cmplt(v, inner.v) & 0xcu)) == 0u;
+	}
+
+	[[nodiscard]] inline packed_rect translated(T dx, T dy) const noexcept { return packed_rect{v + vec::set(dx, dy, dx, dy)}; }
+	[[nodiscard]] inline packed_rect translated(const point<T> & dt) const noexcept { return translated(dt.x, dt.y); }
+	inline void translate(T dx, T dy) noexcept { *this = translated(dx, dy); }
+	[[nodiscard]] inline packed_rect adjusted(T dx1, T dy1, T dx2, T dy2) const noexcept { return packed_rect{v + vec::set(dx1, dy1, dx2, dy2)}; }
+	[[nodiscard]] inline packed_rect expanded(T d) const noexcept { return packed_rect{v + vec::set(-d, -d, d, d)}; }
+	[[nodiscard]] inline packed_rect shrinked(T d) const noexcept { return expanded(-d); }
+
+	/// max/max/min/min without the overlap test
+	[[nodiscard]] inline packed_rect intersected(const packed_rect & other) const noexcept {
+		return packed_rect{lo_hi(max(v, other.v), min(v, other.v))};
+	}
+	/// same empty handling as rect::united
+	[[nodiscard]] inline packed_rect united(const packed_rect & other) const noexcept {
+		if (empty())
+			return other;
+		if (other.empty())
+			return *this;
+		return packed_rect{lo_hi(min(v, other.v), max(v, other.v))};
+	}
+	inline void unite(const packed_rect & other) noexcept { *this = united(other); }
+
+	[[nodiscard]] friend inline bool operator==(const packed_rect & lhs, const packed_rect & rhs) noexcept {
+		return cmpeq(lhs.v, rhs.v) == 0xfu;
+	}
+
+private:
+	vec v;
+};
+
+using packed_recti = packed_rect<int>;
+using packed_rectf = packed_rect<float>;
+
+} //ns geom
+
+#endif //GEOM_SIMD_H
@@ -0,0 +1,225 @@
+#ifndef GEOM_SNAP_H
+#define GEOM_SNAP_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// edge, center-line and equal spacing snapping against many rects
+
+namespace geom {
+
+/// sorted edge arrays per axis (orientation::hor: x lines, orientation::vert: y lines)
+/// queries are a binary search plus a scan over the tolerance window
+template <typename T, typename S = T>
+class snap_index {
+	static_assert(std::is_signed_v<T>, "Snapping needs signed coordinates");
+public:
+	using id_type = std::uint32_t;
+	enum class line : std::uint8_t { start, center, end };
+
+	struct guide {
+		id_type id; /// object providing the snap line
+		line target; /// its line
+		line moving; /// line of the moving rect that snapped
+		T pos; /// snapped coordinate
+		T delta; /// offset to apply to the moving rect
+	};
+
+	struct spacing_guide {
+		id_type before, after; /// neighbours, after is the same as before when repeating its gap
+		T gap;
+		T delta;
+	};
+
+	inline void insert(id_type id, const rect<T, S> & r) {
+		if (!rects.emplace(id, r).second)
+			throw std::invalid_argument("Duplicate snap id");
+		add<orientation::hor>(id, r);
+		add<orientation::vert>(id, r);
+	}
+	inline bool erase(id_type id) {
+		const auto it = rects.find(id);
+		if (it == rects.end())
+			return false;
+		remove<orientation::hor>(id, it->second);
+		remove<orientation::vert>(id, it->second);
+		rects.erase(it);
+		return true;
+	}
+	/// O(log n) search plus a shift of the edge arrays
+	inline void update(id_type id, const rect<T, S> & r) {
+		erase(id);
+		insert(id, r);
+	}
+	inline void clear() noexcept {
+		rects.clear();
+		axes[0].clear();
+		axes[1].clear();
+	}
+	[[nodiscard]] inline std::size_t size() const noexcept { return rects.size(); }
+
+	/// closest line of another rect to any of the moving rect lines along O
+	template <orientation O>
+	[[nodiscard]] std::optional<guide> nearest(const rect<T, S> & moving, T tolerance, std::optional<id_type> exclude = std::nullopt) const {
+		const auto & edges = axes[axis<O>()];
+		const auto ml = lines<O>(moving);
+		std::optional<guide> best;
+		for (unsigned k = 0; k < 3; ++k) {
+			auto it = std::lower_bound(edges.begin(), edges.end(), ml[k] - tolerance, [](const entry & e, T v) { return e.pos < v; });
+			for (; it != edges.end() && it->pos <= ml[k] + tolerance; ++it) {
+				if (exclude && it->id == *exclude)
+					continue;
+				const T d = it->pos - ml[k];
+				if (!best || abs(d) < abs(best->delta))
+					best = guide{it->id, it->l, static_cast<line>(k), it->pos, d};
+			}
+		}
+		return best;
+	}
+
+	/// position making the gaps to the neighbours along O equal, or repeating a neighbour's own gap
+	/// neighbours must overlap the moving rect across O
+	template <orientation O>
+	[[nodiscard]] std::optional<spacing_guide> equal_spacing(const rect<T, S> & moving, T tolerance, std::optional<id_type> exclude = std::nullopt) const {
+		const auto ml = lines<O>(moving);
+		const auto cl = lines<orthogonal<O>>(moving);
+		const auto before = neighbour_before<O>(ml[0] + tolerance, cl[0], cl[2], exclude);
+		const auto after = neighbour_after<O>(ml[2] - tolerance, cl[0], cl[2], exclude);
+		std::optional<spacing_guide> best;
+		const auto consider = [&](id_type b, id_type a, T gap, T delta) {
+			if (abs(delta) <= tolerance && (!best || abs(delta) < abs(best->delta)))
+				best = spacing_guide{b, a, gap, delta};
+		};
+		if (before && after) {
+			const T bl = lines<O>(before->second)[2];
+			const T al = lines<O>(after->second)[0];
+			const T gap = (al - bl - (ml[2] - ml[0])) / T{2};
+			consider(before->first, after->first, gap, bl + gap - ml[0]);
+		}
+		if (before) {
+			const auto bl = lines<O>(before->second);
+			const auto cb = lines<orthogonal<O>>(before->second);
+			if (const auto bb = neighbour_before<O>(bl[0], cb[0], cb[2], exclude, before->first)) {
+				const T gap = bl[0] - lines<O>(bb->second)[2];
+				consider(before->first, before->first, gap, bl[2] + gap - ml[0]);
+			}
+		}
+		if (after) {
+			const auto al = lines<O>(after->second);
+			const auto ca = lines<orthogonal<O>>(after->second);
+			if (const auto aa = neighbour_after<O>(al[2], ca[0], ca[2], exclude, after->first)) {
+				const T gap = lines<O>(aa->second)[0] - al[2];
+				consider(after->first, after->first, gap, al[0] - gap - ml[2]);
+			}
+		}
+		return best;
+	}
+
+	/// moving rect snapped on both axes, edge and center-line guides win over spacing guides
+	[[nodiscard]] rect<T, S> snapped(const rect<T, S> & moving, T tolerance, std::optional<id_type> exclude = std::nullopt) const {
+		return moving.translated(snap_delta<orientation::hor>(moving, tolerance, exclude),
+			snap_delta<orientation::vert>(moving, tolerance, exclude));
+	}
+
+private:
+	struct entry {
+		T pos;
+		id_type id;
+		line l;
+	};
+
+	template <orientation O>
+	static constexpr inline std::size_t axis() noexcept { return O == orientation::hor ? 0u : 1u; }
+
+	[[nodiscard]] static constexpr inline T abs(T v) noexcept { return v < T{0} ? -v : v; }
+
+	/// start, center, end along O
+	template <orientation O>
+	[[nodiscard]] static constexpr inline std::array<T, 3> lines(const rect<T, S> & r) noexcept {
+		if constexpr (O == orientation::hor)
+			return { r.left(), r.left() + (r.right() - r.left()) / T{2}, r.right() };
+		else
+			return { r.top(), r.top() + (r.bottom() - r.top()) / T{2}, r.bottom() };
+	}
+
+	template <orientation O>
+	void add(id_type id, const rect<T, S> & r) {
+		auto & edges = axes[axis<O>()];
+		const auto l = lines<O>(r);
+		for (unsigned k = 0; k < 3; ++k) {
+			const auto it = std::upper_bound(edges.begin(), edges.end(), l[k], [](T v, const entry & e) { return v < e.pos; });
+			edges.insert(it, entry{l[k], id, static_cast<line>(k)});
+		}
+	}
+
+	template <orientation O>
+	void remove(id_type id, const rect<T, S> & r) {
+		auto & edges = axes[axis<O>()];
+		const auto l = lines<O>(r);
+		for (unsigned k = 0; k < 3; ++k) {
+			auto it = std::lower_bound(edges.begin(), edges.end(), l[k], [](const entry & e, T v) { return e.pos < v; });
+			while (it != edges.end() && it->pos == l[k] && !(it->id == id && it->l == static_cast<line>(k)))
+				++it;
+			if (it != edges.end() && it->pos == l[k])
+				edges.erase(it);
+		}
+	}
+
+	[[nodiscard]] static constexpr inline bool skipped(id_type id, std::optional<id_type> exclude, std::optional<id_type> self) noexcept {
+		return (exclude && id == *exclude) || (self && id == *self);
+	}
+
+	/// rect with the largest end line <= pos overlapping [c1, c2) across O, other than exclude and self
+	template <orientation O>
+	std::optional<std::pair<id_type, rect<T, S>>> neighbour_before(T pos, T c1, T c2, std::optional<id_type> exclude, std::optional<id_type> self = std::nullopt) const {
+		const auto & edges = axes[axis<O>()];
+		auto it = std::upper_bound(edges.begin(), edges.end(), pos, [](T v, const entry & e) { return v < e.pos; });
+		while (it != edges.begin()) {
+			--it;
+			if (it->l != line::end || skipped(it->id, exclude, self))
+				continue;
+			const auto & r = rects.at(it->id);
+			const auto cl = lines<orthogonal<O>>(r);
+			if (cl[0] < c2 && c1 < cl[2])
+				return std::pair{it->id, r};
+		}
+		return std::nullopt;
+	}
+
+	/// rect with the smallest start line >= pos overlapping [c1, c2) across O, other than exclude and self
+	template <orientation O>
+	std::optional<std::pair<id_type, rect<T, S>>> neighbour_after(T pos, T c1, T c2, std::optional<id_type> exclude, std::optional<id_type> self = std::nullopt) const {
+		const auto & edges = axes[axis<O>()];
+		for (auto it = std::lower_bound(edges.begin(), edges.end(), pos, [](const entry & e, T v) { return e.pos < v; }); it != edges.end(); ++it) {
+			if (it->l != line::start || skipped(it->id, exclude, self))
+				continue;
+			const auto & r = rects.at(it->id);
+			const auto cl = lines<orthogonal<O>>(r);
+			if (cl[0] < c2 && c1 < cl[2])
+				return std::pair{it->id, r};
+		}
+		return std::nullopt;
+	}
+
+	template <orientation O>
+	T snap_delta(const rect<T, S> & moving, T tolerance, std::optional<id_type> exclude) const {
+		if (const auto g = nearest<O>(moving, tolerance, exclude))
+			return g->delta;
+		if (const auto g = equal_spacing<O>(moving, tolerance, exclude))
+			return g->delta;
+		return T{0};
+	}
+
+	std::unordered_map<id_type, rect<T, S>> rects;
+	std::array<std::vector<entry>, 2> axes;
+};
+
+} //ns geom
+
+#endif //GEOM_SNAP_H
@@ -0,0 +1,301 @@
+#ifndef GEOM_SNAPSHOT_INDEX_H
+#define GEOM_SNAPSHOT_INDEX_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// spatial index with immutable published versions for lock-free concurrent readers (RCU)
+
+namespace geom {
+
+/// hashed uniform grid whose buckets are immutable once published
+/// one writer thread calls insert(), erase(), update() and publish(), readers on other threads pin the
+/// latest published version and query it without locks while the writer prepares the next one
+/// the next version copies only the buckets it changes (and their 64 bucket chunks), the rest is shared,
+/// replaced nodes are freed once no reader pinned before their replacement is still pinned (epochs)
+template <typename T, typename S = T>
+class snapshot_index {
+public:
+	using id_type = std::uint32_t;
+
+private:
+	static constexpr std::size_t chunk_size = 64;
+	static constexpr std::uint64_t idle = std::numeric_limits<std::uint64_t>::max();
+
+	struct entry {
+		std::uint64_t cell;
+		id_type id;
+		rect<T, S> r;
+	};
+	struct bucket {
+		std::uint64_t version;
+		std::vector<entry> entries;
+	};
+	struct chunk {
+		std::uint64_t version;
+		std::array<bucket *, chunk_size> buckets{};
+	};
+	struct root {
+		std::uint64_t version;
+		std::size_t count;
+		std::vector<chunk *> chunks;
+	};
+	struct alignas(64) slot {
+		std::atomic<std::uint64_t> epoch{idle};
+		std::atomic<bool> used{false};
+	};
+	/// nodes unreachable from versions published after epoch
+	struct retired {
+		std::uint64_t epoch = 0;
+		root * r = nullptr;
+		std::vector<chunk *> chunks;
+		std::vector<bucket *> buckets;
+	};
+
+public:
+	/// a pinned published version, valid until destroyed, keep it short lived
+	class snapshot {
+	public:
+		snapshot(snapshot && o) noexcept : idx(o.idx), s(std::exchange(o.s, nullptr)), r(o.r) {}
+		snapshot & operator=(snapshot &&) = delete;
+		~snapshot() {
+			if (s)
+				s->epoch.store(idle, std::memory_order_release);
+		}
+
+		[[nodiscard]] inline std::uint64_t version() const noexcept { return r->version; }
+		[[nodiscard]] inline std::size_t size() const noexcept { return r->count; }
+
+		/// calls f(id, rect) once for every rect sharing a grid cell with q, callers test the actual overlap
+		template <typename F>
+		void query(const rect<T, S> & q, F && f) const {
+			const auto qx1 = idx->cell_of(q.left()), qx2 = idx->cell_of(q.right());
+			const auto qy1 = idx->cell_of(q.top()), qy2 = idx->cell_of(q.bottom());
+			for (auto cy = qy1; cy <= qy2; ++cy) {
+				for (auto cx = qx1; cx <= qx2; ++cx) {
+					const auto key = cell_key(cx, cy);
+					const auto h = idx->hash(key);
+					const chunk * c = r->chunks[h / chunk_size];
+					const bucket * b = c ? c->buckets[h % chunk_size] : nullptr;
+					if (!b)
+						continue;
+					for (const auto & e : b->entries) {
+						/// a rect spanning several cells is reported from the first cell it shares with q only
+						if (e.cell != key || cx != std::max(idx->cell_of(e.r.left()), qx1) || cy != std::max(idx->cell_of(e.r.top()), qy1))
+							continue;
+						f(e.id, e.r);
+					}
+				}
+			}
+		}
+
+	private:
+		friend class snapshot_index;
+		snapshot(const snapshot_index * idx, slot * s, const root * r) noexcept : idx(idx), s(s), r(r) {}
+		const snapshot_index * idx;
+		slot * s;
+		const root * r;
+	};
+
+	/// per reader thread registration holding one epoch slot
+	class reader {
+	public:
+		reader(reader && o) noexcept : idx(o.idx), s(std::exchange(o.s, nullptr)) {}
+		reader & operator=(reader &&) = delete;
+		~reader() {
+			if (s)
+				s->used.store(false, std::memory_order_release);
+		}
+
+		/// the latest published version, one pin per reader at a time
+		[[nodiscard]] snapshot pin() const noexcept {
+			s->epoch.store(idx->epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+			return snapshot(idx, s, idx->current.load(std::memory_order_seq_cst));
+		}
+
+	private:
+		friend class snapshot_index;
+		reader(const snapshot_index * idx, slot * s) noexcept : idx(idx), s(s) {}
+		const snapshot_index * idx;
+		slot * s;
+	};
+
+	/// bucket_count is rounded up to a multiple of 64 and a power of 2
+	explicit snapshot_index(T cell_size, std::size_t bucket_count = 4096, std::size_t max_readers = 64)
+		: cell(cell_size), slots(std::make_unique<slot[]>(max_readers)), slot_count(max_readers)
+	{
+		if (!(cell_size > T{0}))
+			throw std::invalid_argument("Grid cell size must be positive");
+		const auto n = std::bit_ceil(std::max(bucket_count, chunk_size));
+		hash_shift = 64 - std::countr_zero(n);
+		draft.assign(n / chunk_size, nullptr);
+		current.store(new root{0, 0, draft}, std::memory_order_relaxed);
+	}
+	snapshot_index(const snapshot_index &) = delete;
+	snapshot_index & operator=(const snapshot_index &) = delete;
+	/// no reader may be alive
+	~snapshot_index() {
+		for (chunk * c : draft) {
+			if (!c)
+				continue;
+			for (bucket * b : c->buckets)
+				delete b;
+			delete c;
+		}
+		release(pending);
+		for (auto & r : retire)
+			release(r);
+		delete current.load(std::memory_order_relaxed);
+	}
+
+	/// throws std::length_error when all reader slots are taken
+	[[nodiscard]] reader make_reader() {
+		for (std::size_t i = 0; i < slot_count; ++i) {
+			bool expected = false;
+			if (!slots[i].used.load(std::memory_order_relaxed) && slots[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				return reader(this, &slots[i]);
+		}
+		throw std::length_error("No free snapshot_index reader slot");
+	}
+
+	/// writer side, changes become visible to readers on publish()
+	void insert(id_type id, const rect<T, S> & r) {
+		if (id >= items.size())
+			items.resize(id + 1);
+		if (items[id])
+			throw std::invalid_argument("Duplicate snapshot index id");
+		items[id] = r;
+		for_each_cell(r, [&](std::uint64_t key) { writable(hash(key)).push_back(entry{key, id, r}); });
+		++count;
+	}
+	bool erase(id_type id) {
+		if (id >= items.size() || !items[id])
+			return false;
+		for_each_cell(*items[id], [&](std::uint64_t key) {
+			auto & v = writable(hash(key));
+			const auto it = std::find_if(v.begin(), v.end(), [&](const entry & e) { return e.id == id && e.cell == key; });
+			*it = v.back();
+			v.pop_back();
+		});
+		items[id].reset();
+		--count;
+		return true;
+	}
+	void update(id_type id, const rect<T, S> & r) {
+		erase(id);
+		insert(id, r);
+	}
+	[[nodiscard]] inline std::size_t size() const noexcept { return count; }
+	[[nodiscard]] inline const std::optional<rect<T, S>> & at(id_type id) const { return items.at(id); }
+
+	/// makes the changes so far visible to new pins, returns the new version
+	std::uint64_t publish() {
+		root * next = new root{draft_version, count, draft};
+		pending.r = current.exchange(next, std::memory_order_seq_cst);
+		pending.epoch = epoch.fetch_add(1, std::memory_order_seq_cst);
+		retire.push_back(std::move(pending));
+		pending = {};
+		++draft_version;
+		reclaim();
+		return next->version;
+	}
+
+	/// frees replaced nodes no pinned reader can see, returns the number of versions freed
+	std::size_t reclaim() {
+		std::uint64_t oldest = idle;
+		for (std::size_t i = 0; i < slot_count; ++i)
+			oldest = std::min(oldest, slots[i].epoch.load(std::memory_order_seq_cst));
+		std::size_t n = 0;
+		while (!retire.empty() && retire.front().epoch < oldest) {
+			release(retire.front());
+			retire.pop_front();
+			++n;
+		}
+		return n;
+	}
+	[[nodiscard]] inline std::size_t retired_versions() const noexcept { return retire.size(); }
+
+private:
+	[[nodiscard]] inline std::int32_t cell_of(T v) const noexcept {
+		if constexpr (std::is_floating_point_v<T>) {
+			return static_cast<std::int32_t>(std::floor(v / cell));
+		} else if constexpr (std::is_signed_v<T>) {
+			return static_cast<std::int32_t>(v >= 0 ? v / cell : -((-(v + 1)) / cell) - 1);
+		} else {
+			return static_cast<std::int32_t>(v / cell);
+		}
+	}
+	[[nodiscard]] static inline constexpr std::uint64_t cell_key(std::int32_t cx, std::int32_t cy) noexcept {
+		return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy)) << 32) | static_cast<std::uint32_t>(cx);
+	}
+	[[nodiscard]] inline std::size_t hash(std::uint64_t key) const noexcept {
+		return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> hash_shift);
+	}
+
+	template <typename F>
+	inline void for_each_cell(const rect<T, S> & r, F && f) const {
+		const auto cx1 = cell_of(r.left()), cx2 = cell_of(r.right());
+		const auto cy1 = cell_of(r.top()), cy2 = cell_of(r.bottom());
+		for (auto cy = cy1; cy <= cy2; ++cy)
+			for (auto cx = cx1; cx <= cx2; ++cx)
+				f(cell_key(cx, cy));
+	}
+
+	/// bucket h of the draft, copied on first write after a publish
+	std::vector<entry> & writable(std::size_t h) {
+		chunk *& c = draft[h / chunk_size];
+		if (!c || c->version != draft_version) {
+			chunk * copy = new chunk{draft_version, c ? c->buckets : std::array<bucket *, chunk_size>{}};
+			if (c)
+				pending.chunks.push_back(c);
+			c = copy;
+		}
+		bucket *& b = c->buckets[h % chunk_size];
+		if (!b || b->version != draft_version) {
+			bucket * copy = b ? new bucket{draft_version, b->entries} : new bucket{draft_version, {}};
+			if (b)
+				pending.buckets.push_back(b);
+			b = copy;
+		}
+		return b->entries;
+	}
+
+	static void release(retired & r) noexcept {
+		for (bucket * b : r.buckets)
+			delete b;
+		for (chunk * c : r.chunks)
+			delete c;
+		delete r.r;
+	}
+
+	T cell;
+	int hash_shift;
+	std::unique_ptr<slot[]> slots;
+	std::size_t slot_count;
+	std::atomic<std::uint64_t> epoch{1};
+	std::atomic<root *> current{nullptr};
+
+	/// writer state
+	std::vector<chunk *> draft;
+	std::uint64_t draft_version = 1;
+	std::size_t count = 0;
+	std::vector<std::optional<rect<T, S>>> items;
+	retired pending;
+	std::deque<retired> retire;
+};
+
+} //ns geom
+
+#endif //GEOM_SNAPSHOT_INDEX_H
@@ -0,0 +1,56 @@
+#ifndef GEOM_SOA_H
+#define GEOM_SOA_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <vector>
+
+/// structure of arrays storage for bulk rect kernels
+
+namespace geom {
+
+/// rects stored as four coordinate arrays so that bulk loops vectorize
+template <typename T, typename S = T>
+struct rect_soa {
+	using value_type = rect<T, S>;
+	std::vector<T> x1, y1, x2, y2;
+
+	static inline rect_soa from_rects(std::span<const rect<T, S>> rects) {
+		rect_soa soa;
+		soa.reserve(rects.size());
+		for (const auto & r : rects)
+			soa.push_back(r);
+		return soa;
+	}
+
+	[[nodiscard]] inline std::size_t size() const noexcept { return x1.size(); }
+	[[nodiscard]] inline bool empty() const noexcept { return x1.empty(); }
+	inline void reserve(std::size_t n) { x1.reserve(n); y1.reserve(n); x2.reserve(n); y2.reserve(n); }
+	inline void resize(std::size_t n) { x1.resize(n); y1.resize(n); x2.resize(n); y2.resize(n); }
+	inline void clear() noexcept { x1.clear(); y1.clear(); x2.clear(); y2.clear(); }
+	inline void push_back(const rect<T, S> & r) {
+		x1.push_back(r.left()); y1.push_back(r.top());
+		x2.push_back(r.right()); y2.push_back(r.bottom());
+	}
+	[[nodiscard]] inline rect<T, S> operator[](std::size_t i) const { return rect<T, S>(x1[i], y1[i], x2[i], y2[i]); }
+	inline void set(std::size_t i, const rect<T, S> & r) noexcept {
+		x1[i] = r.left(); y1[i] = r.top();
+		x2[i] = r.right(); y2[i] = r.bottom();
+	}
+	[[nodiscard]] std::vector<rect<T, S>> to_rects() const {
+		std::vector<rect<T, S>> rects;
+		rects.reserve(size());
+		for (std::size_t i = 0; i < size(); ++i)
+			rects.push_back((*this)[i]);
+		return rects;
+	}
+};
+
+using rectf_soa = rect_soa<float>;
+using recti_soa = rect_soa<int>;
+
+} //ns geom
+
+#endif //GEOM_SOA_H
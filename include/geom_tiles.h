@@ -0,0 +1,317 @@
+#ifndef GEOM_TILES_H
+#define GEOM_TILES_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// viewport driven tile streaming with C++20 coroutines
+
+namespace geom {
+
+struct tile_key {
+	unsigned level, x, y;
+	[[nodiscard]] friend constexpr inline bool operator==(const tile_key &, const tile_key &) = default;
+};
+
+struct tile_key_hash {
+	[[nodiscard]] inline std::size_t operator()(const tile_key & k) const noexcept {
+		return std::hash<std::uint64_t>{}((std::uint64_t{k.level} << 58) ^ (std::uint64_t{k.y} << 29) ^ k.x);
+	}
+};
+
+/// mip pyramid of an image cut into fixed size tiles
+struct tile_grid {
+	sizeu image_size;
+	sizeu tile_size;
+
+	/// bounds of a tile in level 0 pixels
+	[[nodiscard]] inline rectf tile_rect(const tile_key & k) const noexcept {
+		const auto s = static_cast<float>(1u << k.level);
+		const auto lsz = mip_size(image_size, k.level);
+		const auto x2 = std::min((k.x + 1) * tile_size.width, lsz.width);
+		const auto y2 = std::min((k.y + 1) * tile_size.height, lsz.height);
+		return rectf(static_cast<float>(k.x * tile_size.width) * s, static_cast<float>(k.y * tile_size.height) * s,
+			static_cast<float>(x2) * s, static_cast<float>(y2) * s);
+	}
+
+	/// mip level for showing viewport (level 0 pixels) in output_size screen pixels
+	[[nodiscard]] inline unsigned level_for(const rectf & viewport, sizeu output_size) const noexcept {
+		const auto req = [](unsigned base, unsigned out, float vp) {
+			return vp > 0.f ? std::max(1u, static_cast<unsigned>(static_cast<float>(base) * static_cast<float>(out) / vp)) : base;
+		};
+		const sizeu request{ req(image_size.width, output_size.width, viewport.width()),
+			req(image_size.height, output_size.height, viewport.height()) };
+		return std::min(nearest_mip_level(image_size, request), mip_levels(image_size) - 1u);
+	}
+
+	/// tiles covering the viewport, nearest to the viewport center first
+	[[nodiscard]] std::vector<tile_key> needed(const rectf & viewport, sizeu output_size) const {
+		const unsigned level = level_for(viewport, output_size);
+		const float s = static_cast<float>(1u << level);
+		const auto lsz = mip_size(image_size, level);
+		const unsigned nx = (lsz.width + tile_size.width - 1) / tile_size.width;
+		const unsigned ny = (lsz.height + tile_size.height - 1) / tile_size.height;
+		const auto first = [](float v, float scale, unsigned tile) {
+			return static_cast<unsigned>(std::max(v / scale / static_cast<float>(tile), 0.f));
+		};
+		const auto last = [](float v, float scale, unsigned tile, unsigned n) {
+			return std::min(static_cast<unsigned>(std::max(std::ceil(v / scale / static_cast<float>(tile)), 0.f)), n);
+		};
+		const unsigned x1 = first(viewport.left(), s, tile_size.width), x2 = last(viewport.right(), s, tile_size.width, nx);
+		const unsigned y1 = first(viewport.top(), s, tile_size.height), y2 = last(viewport.bottom(), s, tile_size.height, ny);
+		std::vector<std::pair<float, tile_key>> d;
+		const auto c = viewport.center();
+		for (unsigned y = y1; y < y2; ++y) {
+			for (unsigned x = x1; x < x2; ++x) {
+				const tile_key k{level, x, y};
+				const auto v = tile_rect(k).center() - c;
+				d.emplace_back(v.x * v.x + v.y * v.y, k);
+			}
+		}
+		std::stable_sort(d.begin(), d.end(), [](const auto & a, const auto & b) { return a.first < b.first; });
+		std::vector<tile_key> keys;
+		keys.reserve(d.size());
+		for (const auto & [dist, k] : d)
+			keys.push_back(k);
+		return keys;
+	}
+};
+
+
+/// FIFO pool, jobs posted in priority order start in priority order
+/// jobs still queued at destruction are run by the destroying thread, a suspended coroutine
+/// waiting in the queue always completes (and a tile_streamer waiting for it is released)
+class thread_pool {
+public:
+	explicit thread_pool(unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+		for (unsigned i = 0; i < threads; ++i)
+			workers.emplace_back([this](std::stop_token st) { run(st); });
+	}
+	~thread_pool() {
+		for (auto & w : workers)
+			w.request_stop();
+		cv.notify_all();
+		workers.clear();
+		/// jobs may post further jobs
+		for (;;) {
+			std::function<void()> job;
+			{
+				std::lock_guard lock(mutex);
+				if (jobs.empty())
+					break;
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator=(const thread_pool &) = delete;
+
+	void post(std::function<void()> job) {
+		{
+			std::lock_guard lock(mutex);
+			jobs.push_back(std::move(job));
+		}
+		cv.notify_one();
+	}
+
+	/// co_await pool.schedule() continues the coroutine on a pool thread
+	[[nodiscard]] auto schedule() noexcept {
+		struct awaiter {
+			thread_pool & pool;
+			[[nodiscard]] bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> h) { pool.post([h] { h.resume(); }); }
+			void await_resume() const noexcept {}
+		};
+		return awaiter{*this};
+	}
+
+private:
+	void run(std::stop_token st) {
+		for (;;) {
+			std::function<void()> job;
+			{
+				std::unique_lock lock(mutex);
+				cv.wait(lock, st, [this] { return !jobs.empty(); });
+				if (jobs.empty())
+					return;
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable_any cv;
+	std::deque<std::function<void()>> jobs;
+	std::vector<std::jthread> workers;
+};
+
+
+/// fetch may block (I/O) and decode may be heavy, both run on the pool
+/// both should poll the cancel flag and may give up early
+template <typename Src>
+concept tile_source = requires(Src & s, const tile_key & k, const std::atomic<bool> & cancelled, typename Src::raw_type raw) {
+	{ s.fetch(k, cancelled) } -> std::same_as<std::optional<typename Src::raw_type>>;
+	{ s.decode(k, std::move(raw), cancelled) } -> std::same_as<std::optional<typename Src::tile_type>>;
+};
+
+/// keeps the tiles needed by the current viewport loading
+/// set_viewport() cancels tiles that left the view and starts new ones nearest to the center first,
+/// poll() hands finished tiles over strictly in that order on the calling thread
+template <tile_source Src>
+class tile_streamer {
+public:
+	using tile_type = typename Src::tile_type;
+
+	tile_streamer(Src & source, thread_pool & pool, tile_grid grid) : source(source), pool(pool), grid(grid), st(std::make_shared<shared>()) {}
+	~tile_streamer() {
+		std::unique_lock lock(st->mutex);
+		for (auto & r : order)
+			r->cancelled = true;
+		/// jobs reference the source, wait for them to leave it
+		st->cv.wait(lock, [this] { return st->in_flight == 0; });
+	}
+	tile_streamer(const tile_streamer &) = delete;
+	tile_streamer & operator=(const tile_streamer &) = delete;
+
+	void set_viewport(const rectf & viewport, sizeu output_size) {
+		const auto keys = grid.needed(viewport, output_size);
+		std::unordered_map<tile_key, std::shared_ptr<request>, tile_key_hash> old;
+		for (auto & r : order)
+			old.emplace(r->key, std::move(r));
+		order.clear();
+		std::unordered_set<tile_key, tile_key_hash> next_delivered;
+		for (const auto & k : keys) {
+			if (delivered.contains(k)) {
+				next_delivered.insert(k);
+				continue;
+			}
+			if (auto it = old.find(k); it != old.end()) {
+				order.push_back(std::move(it->second));
+				old.erase(it);
+				continue;
+			}
+			auto r = std::make_shared<request>(k);
+			order.push_back(r);
+			{
+				std::lock_guard lock(st->mutex);
+				++st->in_flight;
+			}
+			load(st, std::move(r), source, pool);
+		}
+		for (auto & [k, r] : old)
+			r->cancelled = true;
+		delivered = std::move(next_delivered);
+	}
+
+	/// calls deliver(key, tile) for ready tiles in priority order, stops at the first one still loading
+	/// failed and cancelled tiles are skipped, returns the number delivered
+	template <typename F>
+	std::size_t poll(F && deliver) {
+		std::size_t n = 0, i = 0;
+		for (; i < order.size(); ++i) {
+			std::optional<tile_type> tile;
+			{
+				std::lock_guard lock(st->mutex);
+				if (order[i]->st == state::loading)
+					break;
+				tile = std::move(order[i]->tile);
+			}
+			if (tile) {
+				delivered.insert(order[i]->key);
+				deliver(order[i]->key, std::move(*tile));
+				++n;
+			}
+		}
+		order.erase(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(i));
+		return n;
+	}
+
+	/// tiles of the current viewport not delivered yet
+	[[nodiscard]] inline std::size_t pending() const noexcept { return order.size(); }
+
+	/// blocks until the front tile is no longer loading, for tests and synchronous callers
+	void wait_front() {
+		if (order.empty())
+			return;
+		std::unique_lock lock(st->mutex);
+		st->cv.wait(lock, [this] { return order.front()->st != state::loading; });
+	}
+
+private:
+	enum class state { loading, done, failed };
+
+	struct request {
+		explicit request(tile_key k) : key(k) {}
+		tile_key key;
+		std::atomic<bool> cancelled{false};
+		state st = state::loading; /// guarded by shared::mutex
+		std::optional<tile_type> tile;
+	};
+
+	/// outlives the streamer while jobs are running
+	struct shared {
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::size_t in_flight = 0;
+	};
+
+	/// eager fire and forget coroutine, frame destroyed on completion
+	struct job {
+		struct promise_type {
+			job get_return_object() noexcept { return {}; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+	};
+
+	static job load(std::shared_ptr<shared> st, std::shared_ptr<request> r, Src & source, thread_pool & pool) {
+		co_await pool.schedule();
+		std::optional<tile_type> tile;
+		try {
+			if (!r->cancelled) {
+				if (auto raw = source.fetch(r->key, r->cancelled); raw && !r->cancelled)
+					tile = source.decode(r->key, std::move(*raw), r->cancelled);
+			}
+		} catch (...) {
+			tile.reset();
+		}
+		std::lock_guard lock(st->mutex);
+		if (tile && !r->cancelled) {
+			r->tile = std::move(tile);
+			r->st = state::done;
+		} else {
+			r->st = state::failed;
+		}
+		--st->in_flight;
+		st->cv.notify_all();
+	}
+
+	Src & source;
+	thread_pool & pool;
+	tile_grid grid;
+	std::shared_ptr<shared> st;
+	std::vector<std::shared_ptr<request>> order; /// current viewport tiles by priority
+	std::unordered_set<tile_key, tile_key_hash> delivered; /// still visible tiles already handed over
+};
+
+} //ns geom
+
+#endif //GEOM_TILES_H
@@ -0,0 +1,249 @@
+#ifndef GEOM_TRACE_H
+#define GEOM_TRACE_H
+
+#ifndef GEOM_H
+#error geom.h must be included first
+#endif
+
+#include <atomic>
+#include <cstdio>
+#include <cstring> /// for memcpy
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/// binary trace of geom operations, enabled by compiling with GEOM_TRACE
+/// file: 8 byte magic "GEOMTRC1", then records of
+///   op (u8), types (u8: T in the low nibble, S in the high nibble, see scalar), operands
+/// operands are 4 byte scalars: rects as x1 y1 x2 y2, sizes as width height, points as x y
+/// nested calls are recorded too, fit_rect records the fitted it calls
+
+namespace geom {
+template <typename T, typename S>
+class rect;
+template <typename T>
+struct size;
+} //ns geom
+
+namespace geom::trace {
+
+enum class op_code : std::uint8_t {
+	intersected = 1, /// rect, rect
+	united, /// rect, rect
+	contains_rect, /// rect, rect
+	contains_point, /// rect, x, y
+	fitted, /// size, size
+	fit_rect, /// rect bounds, size<S>
+	intersect_raw, /// rect, rect
+	intersection_area, /// rect, rect
+	nearest_mip_level, /// size, size
+};
+
+enum class scalar : std::uint8_t { i32 = 0, u32 = 1, f32 = 2 };
+
+[[nodiscard]] inline constexpr bool known(op_code op) noexcept { return op >= op_code::intersected && op <= op_code::nearest_mip_level; }
+[[nodiscard]] inline constexpr bool known(scalar s) noexcept { return s <= scalar::f32; }
+
+inline constexpr char magic[8] = {'G', 'E', 'O', 'M', 'T', 'R', 'C', '1'};
+
+/// bytes of the operands following op and types
+[[nodiscard]] inline constexpr std::size_t operand_size(op_code op) noexcept {
+	switch (op) {
+	case op_code::contains_point:
+	case op_code::fit_rect:
+		return 24;
+	case op_code::fitted:
+	case op_code::nearest_mip_level:
+		return 16;
+	default:
+		return 32;
+	}
+}
+
+namespace detail {
+
+template <typename T>
+[[nodiscard]] inline constexpr std::uint8_t scalar_code() noexcept {
+	static_assert(sizeof(T) == 4 && (std::is_same_v<T, int> || std::is_same_v<T, unsigned> || std::is_same_v<T, float>),
+		"Only int, unsigned and float operands are traced");
+	if constexpr (std::is_same_v<T, int>)
+		return static_cast<std::uint8_t>(scalar::i32);
+	else if constexpr (std::is_same_v<T, unsigned>)
+		return static_cast<std::uint8_t>(scalar::u32);
+	else
+		return static_cast<std::uint8_t>(scalar::f32);
+}
+
+/// operations on other coordinate types (double, short, ...) are not recorded
+template <typename T>
+inline constexpr bool traced_scalar = std::is_same_v<T, int> || std::is_same_v<T, unsigned> || std::is_same_v<T, float>;
+
+template <typename A>
+struct traced : std::bool_constant<traced_scalar<A>> {};
+template <typename T, typename S>
+struct traced<rect<T, S>> : std::bool_constant<traced_scalar<T> && traced_scalar<S>> {};
+template <typename T>
+struct traced<size<T>> : std::bool_constant<traced_scalar<T>> {};
+
+template <typename A>
+struct types_of;
+template <typename T, typename S>
+struct types_of<rect<T, S>> { static constexpr std::uint8_t value = scalar_code<T>() | (scalar_code<S>() << 4); };
+template <typename T>
+struct types_of<size<T>> { static constexpr std::uint8_t value = scalar_code<T>() | (scalar_code<T>() << 4); };
+
+struct buffer;
+
+struct sink {
+	std::mutex mutex;
+	std::FILE * file = nullptr;
+	std::atomic<bool> active{false};
+	std::atomic<std::uint64_t> generation{0};
+	std::vector<buffer *> buffers; /// of live threads, flushed by stop()
+};
+
+[[nodiscard]] inline sink & global() noexcept {
+	static sink s;
+	return s;
+}
+
+/// per thread buffer, written out when full, on stop() and on thread exit
+/// locks: sink::mutex before buffer::mutex, the owning thread alone appends under buffer::mutex
+struct buffer {
+	static constexpr std::size_t capacity = 64 * 1024;
+	std::mutex mutex;
+	std::vector<unsigned char> data;
+	std::uint64_t generation = 0;
+	bool registered = false;
+
+	buffer() noexcept {
+		auto & s = global();
+		std::lock_guard lock(s.mutex);
+		try {
+			s.buffers.push_back(this);
+			registered = true;
+		} catch (...) {
+			/// flushed when full and on thread exit only
+		}
+	}
+	~buffer() {
+		auto & s = global();
+		std::lock_guard lock(s.mutex);
+		write(s);
+		if (registered)
+			std::erase(s.buffers, this);
+	}
+
+	void flush() noexcept {
+		auto & s = global();
+		std::lock_guard lock(s.mutex);
+		write(s);
+	}
+
+	/// sink::mutex is held
+	void write(sink & s) noexcept {
+		std::lock_guard lock(mutex);
+		if (data.empty())
+			return;
+		/// data of a previous trace file is dropped
+		if (s.file && generation == s.generation.load(std::memory_order_relaxed))
+			std::fwrite(data.data(), 1, data.size(), s.file);
+		data.clear();
+	}
+};
+
+inline thread_local buffer local;
+
+inline void put(unsigned char *& p, const void * v, std::size_t n) noexcept {
+	std::memcpy(p, v, n);
+	p += n;
+}
+template <typename T> requires std::is_arithmetic_v<T>
+inline void put(unsigned char *& p, const T & v) noexcept { put(p, &v, sizeof(T)); }
+template <typename T, typename S>
+inline void put(unsigned char *& p, const rect<T, S> & r) noexcept {
+	const T v[4] = { r.left(), r.top(), r.right(), r.bottom() };
+	put(p, v, sizeof(v));
+}
+template <typename T>
+inline void put(unsigned char *& p, const size<T> & sz) noexcept {
+	const T v[2] = { sz.width, sz.height };
+	put(p, v, sizeof(v));
+}
+
+} //ns detail
+
+/// writes out the buffers of all threads and closes the file
+/// records made by other threads while stop() runs may be lost
+inline void stop() {
+	auto & s = detail::global();
+	if (!s.active.exchange(false, std::memory_order_acq_rel))
+		return;
+	std::lock_guard lock(s.mutex);
+	for (auto * b : s.buffers)
+		b->write(s);
+	std::fclose(s.file);
+	s.file = nullptr;
+}
+
+/// starts a new trace, a running one is stopped first
+inline bool start(const char * path) {
+	auto & s = detail::global();
+	stop();
+	std::lock_guard lock(s.mutex);
+	s.file = std::fopen(path, "wb");
+	if (!s.file)
+		return false;
+	std::fwrite(magic, 1, sizeof(magic), s.file);
+	s.generation.fetch_add(1, std::memory_order_relaxed);
+	s.active.store(true, std::memory_order_release);
+	return true;
+}
+
+[[nodiscard]] inline bool active() noexcept { return detail::global().active.load(std::memory_order_relaxed); }
+
+namespace detail {
+
+template <typename... A>
+void write_record(op_code op, const A & ... args) noexcept {
+	auto & s = global();
+	if (!s.active.load(std::memory_order_relaxed))
+		return;
+	using first = std::remove_cvref_t<std::tuple_element_t<0, std::tuple<A...>>>;
+	auto & b = local;
+	std::unique_lock lock(b.mutex);
+	const auto gen = s.generation.load(std::memory_order_relaxed);
+	if (b.generation != gen) {
+		b.data.clear();
+		b.generation = gen;
+	}
+	const std::size_t n = 2 + operand_size(op);
+	if (b.data.size() + n > buffer::capacity) {
+		lock.unlock();
+		b.flush();
+		lock.lock();
+	}
+	try {
+		b.data.reserve(buffer::capacity);
+	} catch (...) {
+		return;
+	}
+	const auto old = b.data.size();
+	b.data.resize(old + n);
+	unsigned char * p = b.data.data() + old;
+	*p++ = static_cast<unsigned char>(op);
+	*p++ = types_of<first>::value;
+	(put(p, args), ...);
+}
+
+} //ns detail
+
+template <typename... A>
+void record(op_code op, const A & ... args) noexcept {
+	if constexpr ((detail::traced<std::remove_cvref_t<A>>::value && ...))
+		detail::write_record(op, args...);
+}
+
+} //ns geom::trace
+
+#endif //GEOM_TRACE_H
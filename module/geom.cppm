@@ -0,0 +1,73 @@
+module;
+
+#include "geom.h"
+
+export module geom;
+
+export namespace geom {
+
+using geom::deg2rad;
+using geom::rad2deg;
+
+using geom::point;
+using geom::pointi;
+using geom::pointu;
+using geom::pointf;
+using geom::operator+;
+using geom::operator-;
+using geom::operator*;
+using geom::operator/;
+using geom::operator==;
+using geom::operator!=;
+
+using geom::size;
+using geom::sizei;
+using geom::sizeu;
+using geom::sizef;
+using geom::scale_factor;
+
+using geom::insets;
+using geom::insetsi;
+using geom::insetsu;
+using geom::insetsf;
+
+using geom::rect;
+using geom::recti;
+using geom::rectu;
+using geom::rectf;
+using geom::rectn;
+#ifdef _WIN32
+using geom::pPOINT_adapter;
+using geom::pRECT_adapter;
+#endif
+
+using geom::intersect;
+using geom::unite;
+using geom::for_each_difference;
+using geom::area_t;
+using geom::raw_intersection;
+using geom::intersect_raw;
+using geom::intersection_area;
+using geom::area;
+using geom::iou;
+using geom::fit_rect;
+using geom::clamp;
+
+using geom::orientation;
+using geom::orthogonal;
+
+using geom::mip_levels;
+using geom::mip_size;
+using geom::nearest_mip_level;
+
+} //ns geom
+
+/// common types are compiled once here instead of in every importer
+namespace geom {
+template struct point<int>;
+template struct point<float>;
+template struct size<unsigned>;
+template class rect<int>;
+template class rect<int, unsigned>;
+template class rect<float>;
+} //ns geom
@@ -0,0 +1,212 @@
+/// Python bindings: point and rect classes plus bulk functions over NumPy arrays
+/// bulk functions read C-contiguous float32 (N,4) rect and (N,2) point arrays without copying,
+/// other dtypes or layouts are converted first by pybind11; results are always new arrays
+
+#include "include/geom.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/operators.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+namespace {
+
+template <typename T>
+using carray = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+/// rows of an (N, cols) array, a single (cols,) row broadcasts
+template <typename T>
+std::size_t rows_of(const carray<T> & a, py::ssize_t cols, const char * name) {
+	if (a.ndim() == 1 && a.shape(0) == cols)
+		return 1;
+	if (a.ndim() != 2 || a.shape(1) != cols)
+		throw py::value_error(std::string(name) + " must have shape (N, " + std::to_string(cols) + ")");
+	return static_cast<std::size_t>(a.shape(0));
+}
+
+/// common row count of two arrays where either may broadcast
+std::size_t broadcast_rows(std::size_t a, std::size_t b) {
+	if (a != b && a != 1 && b != 1)
+		throw py::value_error("Row counts do not match");
+	return std::max(a, b);
+}
+
+inline geom::rectf load_rect(const float * p) noexcept { return geom::rectf(p[0], p[1], p[2], p[3]); }
+
+inline void store_rect(float * p, const geom::rectf & r) noexcept {
+	p[0] = r.left(); p[1] = r.top(); p[2] = r.right(); p[3] = r.bottom();
+}
+
+/// intersections of a[i] and b[i], returns the (N,4) rects (inverted when empty) and the (N,) validity mask
+py::tuple bulk_intersect(const carray<float> & a, const carray<float> & b) {
+	const auto na = rows_of(a, 4, "a"), nb = rows_of(b, 4, "b");
+	const auto n = broadcast_rows(na, nb);
+	carray<float> out({static_cast<py::ssize_t>(n), py::ssize_t{4}});
+	py::array_t<bool> valid(static_cast<py::ssize_t>(n));
+	const float * pa = a.data();
+	const float * pb = b.data();
+	float * po = out.mutable_data();
+	bool * pv = valid.mutable_data();
+	{
+		py::gil_scoped_release release;
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto r = geom::intersect_raw(load_rect(pa + (na == 1 ? 0 : i * 4)), load_rect(pb + (nb == 1 ? 0 : i * 4)));
+			store_rect(po + i * 4, r.r);
+			pv[i] = r.valid;
+		}
+	}
+	return py::make_tuple(out, valid);
+}
+
+/// union of all rects with rect::united semantics, None for an empty array
+std::optional<geom::rectf> unite_reduce(const carray<float> & a) {
+	const auto n = a.size() == 0 ? 0 : rows_of(a, 4, "a");
+	const float * p = a.data();
+	std::optional<geom::rectf> u;
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i)
+		u = geom::unite(u, load_rect(p + i * 4));
+	return u;
+}
+
+/// rects[i].contains(points[i]), either side may be a single row
+py::array_t<bool> bulk_contains(const carray<float> & rects, const carray<float> & points) {
+	const auto nr = rows_of(rects, 4, "rects"), np = rows_of(points, 2, "points");
+	const auto n = broadcast_rows(nr, np);
+	py::array_t<bool> out(static_cast<py::ssize_t>(n));
+	const float * pr = rects.data();
+	const float * pp = points.data();
+	bool * po = out.mutable_data();
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i) {
+		const float * q = pp + (np == 1 ? 0 : i * 2);
+		po[i] = load_rect(pr + (nr == 1 ? 0 : i * 4)).contains(q[0], q[1]);
+	}
+	return out;
+}
+
+/// fit_rect(sizes[i], bounds[i]) for (N,2) sizes and (N,4) bounds
+carray<float> bulk_fit_rect(const carray<float> & sizes, const carray<float> & bounds) {
+	const auto ns = rows_of(sizes, 2, "sizes"), nb = rows_of(bounds, 4, "bounds");
+	const auto n = broadcast_rows(ns, nb);
+	carray<float> out({static_cast<py::ssize_t>(n), py::ssize_t{4}});
+	const float * ps = sizes.data();
+	const float * pb = bounds.data();
+	float * po = out.mutable_data();
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i) {
+		const float * s = ps + (ns == 1 ? 0 : i * 2);
+		store_rect(po + i * 4, geom::fit_rect(geom::sizef{s[0], s[1]}, load_rect(pb + (nb == 1 ? 0 : i * 4))));
+	}
+	return out;
+}
+
+py::array_t<unsigned> bulk_mip_levels(const carray<unsigned> & sizes, unsigned trim_levels) {
+	const auto n = rows_of(sizes, 2, "sizes");
+	py::array_t<unsigned> out(static_cast<py::ssize_t>(n));
+	const unsigned * ps = sizes.data();
+	unsigned * po = out.mutable_data();
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i)
+		po[i] = geom::mip_levels(geom::sizeu{ps[i * 2], ps[i * 2 + 1]}, trim_levels);
+	return out;
+}
+
+py::array_t<unsigned> bulk_nearest_mip_level(const carray<unsigned> & base, const carray<unsigned> & request) {
+	const auto nb = rows_of(base, 2, "base"), nr = rows_of(request, 2, "request");
+	const auto n = broadcast_rows(nb, nr);
+	py::array_t<unsigned> out(static_cast<py::ssize_t>(n));
+	const unsigned * pb = base.data();
+	const unsigned * pr = request.data();
+	/// geom::nearest_mip_level divides the base size by the request
+	for (std::size_t i = 0; i < nr; ++i)
+		if (pr[i * 2] == 0 || pr[i * 2 + 1] == 0)
+			throw py::value_error("Request sizes must have non-zero width and height");
+	unsigned * po = out.mutable_data();
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i) {
+		const unsigned * b = pb + (nb == 1 ? 0 : i * 2);
+		const unsigned * r = pr + (nr == 1 ? 0 : i * 2);
+		po[i] = geom::nearest_mip_level(geom::sizeu{b[0], b[1]}, geom::sizeu{r[0], r[1]});
+	}
+	return out;
+}
+
+carray<unsigned> bulk_mip_size(const carray<unsigned> & base, unsigned level) {
+	/// geom::mip_size shifts by level
+	if (level >= 32)
+		throw py::value_error("Mip level must be below 32");
+	const auto n = rows_of(base, 2, "base");
+	carray<unsigned> out({static_cast<py::ssize_t>(n), py::ssize_t{2}});
+	const unsigned * pb = base.data();
+	unsigned * po = out.mutable_data();
+	py::gil_scoped_release release;
+	for (std::size_t i = 0; i < n; ++i) {
+		const auto s = geom::mip_size(geom::sizeu{pb[i * 2], pb[i * 2 + 1]}, level);
+		po[i * 2] = s.width;
+		po[i * 2 + 1] = s.height;
+	}
+	return out;
+}
+
+template <typename T>
+void bind_point(py::module_ & m, const char * name) {
+	using P = geom::point<T>;
+	py::class_<P>(m, name)
+		.def(py::init([](T x, T y) { return P{x, y}; }), py::arg("x"), py::arg("y"))
+		.def_readwrite("x", &P::x)
+		.def_readwrite("y", &P::y)
+		.def(py::self + py::self)
+		.def(py::self - py::self)
+		.def(py::self == py::self)
+		.def("__repr__", [name](const P & p) { return std::string(name) + "(" + std::to_string(p.x) + ", " + std::to_string(p.y) + ")"; });
+}
+
+template <typename T>
+void bind_rect(py::module_ & m, const char * name) {
+	using R = geom::rect<T>;
+	using P = geom::point<T>;
+	py::class_<R>(m, name)
+		.def(py::init<T, T, T, T>(), py::arg("x1"), py::arg("y1"), py::arg("x2"), py::arg("y2"))
+		.def_property_readonly("left", &R::left)
+		.def_property_readonly("top", &R::top)
+		.def_property_readonly("right", &R::right)
+		.def_property_readonly("bottom", &R::bottom)
+		.def_property_readonly("width", &R::width)
+		.def_property_readonly("height", [](const R & r) { return r.height(); })
+		.def_property_readonly("center", &R::center)
+		.def("empty", &R::empty)
+		.def("contains", py::overload_cast<const P &>(&R::contains, py::const_))
+		.def("contains", py::overload_cast<const R &>(&R::contains, py::const_))
+		.def("translated", py::overload_cast<T, T>(&R::translated, py::const_))
+		.def("expanded", &R::expanded)
+		.def("united", &R::united)
+		.def("intersected", &R::intersected)
+		.def(py::self == py::self)
+		.def("__repr__", [name](const R & r) {
+			return std::string(name) + "(" + std::to_string(r.left()) + ", " + std::to_string(r.top()) + ", "
+				+ std::to_string(r.right()) + ", " + std::to_string(r.bottom()) + ")";
+		});
+}
+
+} //ns
+
+PYBIND11_MODULE(geom, m) {
+	m.doc() = "geom point/rect primitives and bulk NumPy operations";
+
+	bind_point<int>(m, "pointi");
+	bind_point<float>(m, "pointf");
+	bind_rect<int>(m, "recti");
+	bind_rect<float>(m, "rectf");
+
+	m.def("intersect", &bulk_intersect, py::arg("a"), py::arg("b"),
+		"Row-wise intersection of (N,4) rect arrays, returns (rects, valid)");
+	m.def("unite_reduce", &unite_reduce, py::arg("rects"), "Union of all rows of a (N,4) rect array");
+	m.def("contains", &bulk_contains, py::arg("rects"), py::arg("points"), "Row-wise rect.contains(point)");
+	m.def("fit_rect", &bulk_fit_rect, py::arg("sizes"), py::arg("bounds"), "Row-wise fit_rect of (N,2) sizes into (N,4) bounds");
+	m.def("mip_levels", &bulk_mip_levels, py::arg("sizes"), py::arg("trim_levels") = 0u);
+	m.def("nearest_mip_level", &bulk_nearest_mip_level, py::arg("base"), py::arg("request"));
+	m.def("mip_size", &bulk_mip_size, py::arg("base"), py::arg("level"));
+}
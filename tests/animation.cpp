@@ -0,0 +1,107 @@
+#include "include/geom.h"
+#include "include/geom_animation.h"
+#include "check.h"
+
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+rectf_soa soa(std::initializer_list<rectf> rects) {
+	rectf_soa s;
+	for (const auto & r : rects)
+		s.push_back(r);
+	return s;
+}
+
+bool same(const rectf_soa & a, const rectf_soa & b) {
+	return a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+}
+
+} //ns
+
+int main() {
+	/// lerp: unchanged rects stay out of the damage, t is clamped, the ease is applied
+	{
+		const auto from = soa({ rectf(0.f, 0.f, 10.f, 10.f), rectf(100.f, 100.f, 110.f, 110.f), rectf(-20.f, -20.f, -10.f, -10.f) });
+		const auto to = soa({ rectf(10.f, 0.f, 20.f, 10.f), rectf(100.f, 100.f, 110.f, 110.f), rectf(-20.f, -40.f, -10.f, -30.f) });
+		auto cur = from;
+		const std::vector<float> t{ .5f, .5f, -1.f };
+		CHECK(lerp(from, to, t, cur) == rectf(0.f, 0.f, 15.f, 10.f));
+		CHECK(cur[0] == rectf(5.f, 0.f, 15.f, 10.f) && cur[1] == from[1] && cur[2] == from[2]);
+		CHECK(!lerp(from, to, t, cur).has_value());
+		const std::vector<float> end{ 2.f, 2.f, 2.f };
+		CHECK(lerp(from, to, end, cur) == rectf(-20.f, -40.f, 20.f, 10.f));
+		CHECK(same(cur, to));
+		CHECK(lerp(from, to, t, cur, ease::in_quad) == rectf(-20.f, -40.f, 20.f, 10.f));
+		CHECK(cur[0] == rectf(2.5f, 0.f, 12.5f, 10.f));
+		CHECK_THROWS(std::invalid_argument, lerp(from, to, std::span<const float>(t.data(), 2), cur));
+		rectf_soa small = soa({ rectf(0.f, 0.f, 1.f, 1.f) });
+		CHECK_THROWS(std::invalid_argument, lerp(from, to, t, small));
+	}
+
+	/// keyframes: held before the first and after the last key, interpolated within segments
+	{
+		const std::vector<rectf_soa> frames{ soa({ rectf(0.f, 0.f, 10.f, 10.f) }), soa({ rectf(10.f, 0.f, 20.f, 10.f) }), soa({ rectf(10.f, 20.f, 20.f, 30.f) }) };
+		const std::vector<float> times{ 1.f, 2.f, 4.f };
+		auto cur = frames[0];
+		CHECK(!sample_keyframes(frames, times, -5.f, cur).has_value());
+		CHECK(!sample_keyframes(frames, times, 1.f, cur).has_value());
+		CHECK(sample_keyframes(frames, times, 1.5f, cur) == rectf(0.f, 0.f, 15.f, 10.f));
+		CHECK(cur[0] == rectf(5.f, 0.f, 15.f, 10.f));
+		sample_keyframes(frames, times, 2.f, cur);
+		CHECK(cur[0] == frames[1][0]);
+		CHECK(sample_keyframes(frames, times, 3.f, cur) == rectf(10.f, 0.f, 20.f, 20.f));
+		CHECK(cur[0] == rectf(10.f, 10.f, 20.f, 20.f));
+		sample_keyframes(frames, times, 100.f, cur);
+		CHECK(cur[0] == frames[2][0]);
+		CHECK(!sample_keyframes(frames, times, 4.f, cur).has_value());
+		sample_keyframes(frames, times, 3.f, cur, ease::in_quad);
+		CHECK(cur[0] == rectf(10.f, 5.f, 20.f, 15.f));
+		/// a single key holds everywhere
+		auto one = frames[1];
+		CHECK(!sample_keyframes(std::span(frames).subspan(1, 1), std::span(times).subspan(1, 1), -1.f, one).has_value());
+		CHECK_THROWS(std::invalid_argument, sample_keyframes(frames, std::span(times).first(2), 1.f, cur));
+		CHECK_THROWS(std::invalid_argument, sample_keyframes(std::span<const rectf_soa>(), std::span<const float>(), 1.f, cur));
+	}
+
+	/// spring: approaches the target without overshoot, settles exactly and stops reporting damage
+	{
+		const auto target = soa({ rectf(100.f, 50.f, 120.f, 60.f), rectf(0.f, 0.f, 5.f, 5.f) });
+		auto cur = soa({ rectf(0.f, 0.f, 10.f, 10.f), rectf(0.f, 0.f, 5.f, 5.f) });
+		rectf_soa vel;
+		vel.resize(2);
+		const auto first = spring_step(cur, vel, target, 10.f, 1.f / 60.f);
+		CHECK(first && first->left() == 0.f && first->top() == 0.f && first->right() > 10.f && first->right() < 120.f);
+		CHECK(cur[1] == target[1]);
+		float prev = 100.f;
+		int steps = 1;
+		while (spring_step(cur, vel, target, 10.f, 1.f / 60.f)) {
+			const float d = target.x1[0] - cur.x1[0];
+			CHECK(d >= 0.f && d <= prev);
+			prev = d;
+			if (++steps > 1000)
+				break;
+		}
+		CHECK(steps < 200);
+		CHECK(same(cur, target) && vel.x1[0] == 0.f && vel.y2[0] == 0.f);
+		CHECK(!spring_step(cur, vel, target, 10.f, 1.f / 60.f).has_value());
+		/// a huge dt lands on the target in one stable step
+		auto jump = soa({ rectf(0.f, 0.f, 10.f, 10.f), rectf(0.f, 0.f, 5.f, 5.f) });
+		vel.clear();
+		vel.resize(2);
+		CHECK(spring_step(jump, vel, target, 10.f, 10.f) == rectf(0.f, 0.f, 120.f, 60.f));
+		CHECK(same(jump, target));
+	}
+
+	/// snap rounds edges, rects sharing an edge keep sharing it
+	{
+		const auto in = soa({ rectf(0.4f, 0.5f, 10.5f, 2.49f), rectf(10.5f, 0.5f, 20.2f, 2.49f) });
+		recti_soa out;
+		CHECK(snap(in, out) == recti(0, 0, 20, 2));
+		CHECK(out[0] == recti(0, 1, 11, 2) && out[1] == recti(11, 1, 20, 2));
+		CHECK(!snap(in, out).has_value());
+	}
+	return geom_test::failures;
+}
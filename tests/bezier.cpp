@@ -0,0 +1,107 @@
+#include "include/geom.h"
+#include "include/geom_bezier.h"
+#include "check.h"
+
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+constexpr int samples = 4096;
+
+/// extent of densely sampled points, evaluated in double
+template <typename F>
+rectf extent_of(F && at) {
+	double x1 = 1e300, y1 = 1e300, x2 = -1e300, y2 = -1e300;
+	for (int i = 0; i <= samples; ++i) {
+		const auto [x, y] = at(static_cast<double>(i) / samples);
+		x1 = std::min(x1, x); y1 = std::min(y1, y);
+		x2 = std::max(x2, x); y2 = std::max(y2, y);
+	}
+	return rectf(static_cast<float>(x1), static_cast<float>(y1), static_cast<float>(x2), static_cast<float>(y2));
+}
+
+rectf sampled(const cubic_bezier & c) {
+	return extent_of([&](double t) {
+		const double u = 1. - t;
+		const auto at = [&](float a, float b, float cc, float d) { return u * u * u * a + 3. * u * u * t * b + 3. * u * t * t * cc + t * t * t * d; };
+		return std::pair{ at(c.p0.x, c.p1.x, c.p2.x, c.p3.x), at(c.p0.y, c.p1.y, c.p2.y, c.p3.y) };
+	});
+}
+
+rectf sampled(const quad_bezier & c) {
+	return extent_of([&](double t) {
+		const double u = 1. - t;
+		const auto at = [&](float a, float b, float cc) { return u * u * a + 2. * u * t * b + t * t * cc; };
+		return std::pair{ at(c.p0.x, c.p1.x, c.p2.x), at(c.p0.y, c.p1.y, c.p2.y) };
+	});
+}
+
+/// bounds contain every sample and exceed their extent by float rounding only, relative to the curve size
+bool tight(const rectf & b, const rectf & s, float scale) {
+	const float tol = 1e-4f * scale;
+	return b.left() <= s.left() + tol && b.top() <= s.top() + tol && b.right() >= s.right() - tol && b.bottom() >= s.bottom() - tol
+		&& b.left() >= s.left() - tol && b.top() >= s.top() - tol && b.right() <= s.right() + tol && b.bottom() <= s.bottom() + tol;
+}
+
+bool same(const rectf & a, const rectf & b, float scale) {
+	const float tol = 1e-5f * scale;
+	return std::abs(a.left() - b.left()) <= tol && std::abs(a.top() - b.top()) <= tol
+		&& std::abs(a.right() - b.right()) <= tol && std::abs(a.bottom() - b.bottom()) <= tol;
+}
+
+rectf soa_rect(const rectf_soa & r, std::size_t i) {
+	return rectf(r.x1[i], r.y1[i], r.x2[i], r.y2[i]);
+}
+
+} //ns
+
+int main() {
+	/// interior extrema on both axes
+	const cubic_bezier loop{{0.f, 0.f}, {3.f, -3.f}, {-3.f, 3.f}, {0.f, 0.f}};
+	CHECK(tight(bounds(loop), sampled(loop), 1.f) && bounds(loop).left() < -.5f && bounds(loop).right() > .5f);
+	CHECK(bounds(quad_bezier{{0.f, 0.f}, {1.f, 2.f}, {2.f, 0.f}}) == rectf(0.f, 0.f, 2.f, 1.f));
+	CHECK(bounds(quad_bezier{{0.f, 0.f}, {1.f, 2.f}, {2.f, 0.f}}, 2.f) == rectf(-1.f, -1.f, 3.f, 2.f));
+	/// straight lines, a constant coordinate and a vanishing quadratic term (linear derivative)
+	CHECK(bounds(cubic_bezier{{0.f, 1.f}, {1.f, 1.f}, {2.f, 1.f}, {3.f, 1.f}}) == rectf(0.f, 1.f, 3.f, 1.f));
+	CHECK(bounds(cubic_bezier{{0.f, 0.f}, {2.f, 0.f}, {2.f, 0.f}, {0.f, 0.f}}) == rectf(0.f, 0.f, 1.5f, 0.f));
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	/// tiny scales catch absolute epsilons, large ones cancellation in the roots
+	for (const float scale : { 1e-15f, 1e-6f, 1.f, 1e3f, 1e6f }) {
+		const float off = scale * 3.f;
+		const auto p = [&] { return pointf{ off + scale * unit(rng), scale * unit(rng) }; };
+		cubic_bezier_soa cs;
+		quad_bezier_soa qs;
+		for (int i = 0; i < 203; ++i) {
+			cubic_bezier c{ p(), p(), p(), p() };
+			quad_bezier q{ p(), p(), p() };
+			if (i % 5 == 1) {
+				/// evenly spaced x control points, A = 0 up to rounding
+				c.p1 = { c.p0.x + (c.p3.x - c.p0.x) / 3.f, c.p0.y + (c.p3.y - c.p0.y) / 3.f };
+				c.p2 = { c.p0.x + (c.p3.x - c.p0.x) * 2.f / 3.f, c.p2.y };
+				q.p1 = { (q.p0.x + q.p2.x) * .5f, q.p1.y };
+			} else if (i % 5 == 2) {
+				/// symmetric curves, B = 0
+				c.p3 = c.p0;
+				c.p2 = c.p1;
+				q.p2 = q.p0;
+			}
+			cs.push_back(c);
+			qs.push_back(q);
+		}
+		rectf_soa cb, qb;
+		bounds(cs, cb, scale);
+		bounds(qs, qb);
+		for (std::size_t i = 0; i < cs.size(); ++i) {
+			const rectf c = bounds(cs[i]), q = bounds(qs[i]);
+			CHECK(tight(c, sampled(cs[i]), scale));
+			CHECK(tight(q, sampled(qs[i]), scale));
+			CHECK(same(soa_rect(cb, i), bounds(cs[i], scale), scale));
+			CHECK(same(soa_rect(qb, i), q, scale));
+		}
+	}
+	return geom_test::failures;
+}
@@ -0,0 +1,78 @@
+#include "include/geom.h"
+#include "include/geom_bvh.h"
+#include "check.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+template <typename T>
+bool overlaps(const rect<T> & a, const rect<T> & b) noexcept {
+	return std::max(a.left(), b.left()) < std::min(a.right(), b.right()) && std::max(a.top(), b.top()) < std::min(a.bottom(), b.bottom());
+}
+
+/// rect and point queries against a linear scan, before and after moving a third of the rects and refitting
+template <typename T, unsigned W>
+void check_bvh(bvh_build method, unsigned n) {
+	std::mt19937 g(n + W);
+	std::uniform_real_distribution<float> u(0.f, 10000.f), s(1.f, 60.f);
+	std::vector<rect<T>> rs;
+	for (unsigned i = 0; i < n; ++i) {
+		const T x = static_cast<T>(u(g)), y = static_cast<T>(u(g));
+		rs.emplace_back(x, y, x + static_cast<T>(s(g)), y + static_cast<T>(s(g)));
+	}
+	bvh<T, T, W> b(std::span<const rect<T>>(rs), method, 4);
+	CHECK(b.size() == n);
+
+	const auto compare = [&] {
+		for (int q = 0; q < 200; ++q) {
+			const T x = static_cast<T>(u(g)), y = static_cast<T>(u(g));
+			const rect<T> qr(x, y, x + static_cast<T>(s(g) * 5.f), y + static_cast<T>(s(g) * 5.f));
+			std::vector<unsigned> got, want;
+			b.query(qr, [&](unsigned id, const rect<T> &) { got.push_back(id); });
+			for (unsigned i = 0; i < n; ++i)
+				if (overlaps(rs[i], qr))
+					want.push_back(i);
+			std::sort(got.begin(), got.end());
+			CHECK(got == want);
+
+			const point<T> p{x, y};
+			got.clear();
+			want.clear();
+			b.query(p, [&](unsigned id, const rect<T> &) { got.push_back(id); });
+			for (unsigned i = 0; i < n; ++i)
+				if (rs[i].contains(p))
+					want.push_back(i);
+			std::sort(got.begin(), got.end());
+			CHECK(got == want);
+		}
+	};
+	compare();
+	for (unsigned i = 0; i < n; i += 3) {
+		rs[i] = rs[i].translated(static_cast<T>(37), static_cast<T>(-11));
+		b.update(i, rs[i]);
+	}
+	b.refit();
+	compare();
+
+	/// returning false stops the traversal
+	unsigned hits = 0;
+	b.query(rect<T>(0, 0, 10000, 10000), [&](unsigned, const rect<T> &) { return ++hits < 5; });
+	CHECK(hits == std::min(n, 5u));
+}
+
+} //ns
+
+int main() {
+	for (unsigned n : {0u, 1u, 3u, 100u, 3000u}) {
+		check_bvh<float, 4>(bvh_build::sah, n);
+		check_bvh<float, 8>(bvh_build::morton, n);
+		check_bvh<int, 4>(bvh_build::morton, n);
+		check_bvh<int, 8>(bvh_build::sah, n);
+	}
+	return geom_test::failures;
+}
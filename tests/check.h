@@ -0,0 +1,31 @@
+#ifndef GEOM_TESTS_CHECK_H
+#define GEOM_TESTS_CHECK_H
+
+#include <cstdio>
+#include <exception>
+
+/// minimal assertion helpers for the test programs, main returns the number of failures
+
+namespace geom_test {
+
+inline int failures = 0;
+
+inline void check(bool ok, const char * expr, const char * file, int line) {
+	if (ok)
+		return;
+	++failures;
+	std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+}
+
+} //ns geom_test
+
+#define CHECK(...) ::geom_test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/// checks that expr throws E
+#define CHECK_THROWS(E, ...) do { \
+	bool thrown_ = false; \
+	try { (void)(__VA_ARGS__); } catch (const E &) { thrown_ = true; } \
+	::geom_test::check(thrown_, "throws " #E ": " #__VA_ARGS__, __FILE__, __LINE__); \
+} while (false)
+
+#endif //GEOM_TESTS_CHECK_H
@@ -0,0 +1,53 @@
+#include "include/geom.h"
+#include "include/geom_display.h"
+#include "check.h"
+
+#include <random>
+
+using namespace geom;
+
+/// containing() and from_rect() against a scan of all monitors, queried in an order that exercises the caches
+static void brute_force(const display_layout & d, std::mt19937 & g) {
+	std::uniform_int_distribution<int> c(-200, 3200), extent(1, 300);
+	for (int i = 0; i < 2000; ++i) {
+		const pointi pt{c(g), c(g) / 2};
+		auto expected = display_layout::npos;
+		for (std::size_t m = 0; m < d.size() && expected == display_layout::npos; ++m)
+			if (d[m].bounds.contains(pt))
+				expected = m;
+		CHECK(d.containing(pt) == expected);
+
+		const recti r(pt.x, pt.y, pt.x + extent(g), pt.y + extent(g));
+		std::uint64_t best_area = 0;
+		expected = display_layout::npos;
+		for (std::size_t m = 0; m < d.size(); ++m) {
+			if (const auto a = intersection_area(d[m].bounds, r); a > best_area) {
+				best_area = a;
+				expected = m;
+			}
+		}
+		CHECK(d.from_rect(r, monitor_fallback::none) == expected);
+	}
+}
+
+int main() {
+	/// overlapping monitors, the lowest index wins even after the cache saw the other one
+	display_layout overlapping({{recti(0, 0, 1000, 800), recti(0, 0, 1000, 760)}, {recti(500, 0, 1500, 800), recti(500, 0, 1500, 760)}});
+	CHECK(overlapping.containing({1200, 10}) == 1);
+	CHECK(overlapping.containing({600, 10}) == 0);
+	CHECK(overlapping.containing({1200, 10}) == 1);
+	CHECK(overlapping.containing({2000, 10}) == display_layout::npos);
+
+	std::mt19937 g(7);
+	brute_force(overlapping, g);
+	display_layout side_by_side({{recti(0, 0, 1920, 1080), recti(0, 0, 1920, 1040)}, {recti(1920, 0, 3200, 1024), recti(1920, 0, 3200, 1024)},
+		{recti(-100, 1080, 1000, 1500), recti(-100, 1080, 1000, 1500)}}, 1);
+	brute_force(side_by_side, g);
+	display_layout stacked({{recti(0, 0, 3000, 1500), recti(0, 0, 3000, 1500)}, {recti(100, 100, 900, 700), recti(100, 100, 900, 700)},
+		{recti(800, 600, 2000, 1400), recti(800, 600, 2000, 1400)}});
+	brute_force(stacked, g);
+
+	CHECK(side_by_side.clamp({-500, 10}) == pointi(0, 10));
+	CHECK(side_by_side.move_onto(recti(3100, 100, 3300, 200)) == recti(3000, 100, 3200, 200));
+	return geom_test::failures;
+}
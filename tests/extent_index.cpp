@@ -0,0 +1,109 @@
+#include "include/geom.h"
+#include "include/geom_extent_index.h"
+#include "check.h"
+
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+/// compares offsets, index_at and visible_range of idx with linear scans over the extents
+template <orientation O>
+bool matches(const item_extent_index<O> & idx, const std::vector<unsigned> & ext, std::mt19937 & rng) {
+	std::vector<std::uint64_t> pre(ext.size() + 1, 0);
+	for (std::size_t i = 0; i < ext.size(); ++i)
+		pre[i + 1] = pre[i] + ext[i];
+	if (idx.size() != ext.size() || idx.total() != pre.back())
+		return false;
+	for (std::size_t i = 0; i <= ext.size(); ++i) {
+		if (idx.offset(i) != pre[i])
+			return false;
+	}
+	const auto index_ref = [&](std::uint64_t off) {
+		std::size_t i = 0;
+		while (i < ext.size() && pre[i + 1] <= off)
+			++i;
+		return i;
+	};
+	std::uniform_int_distribution<std::uint64_t> off(0, pre.back() + 5);
+	for (int k = 0; k < 50; ++k) {
+		const auto o = off(rng);
+		if (idx.index_at(o) != index_ref(o))
+			return false;
+	}
+	for (std::size_t i = 0; i <= ext.size(); ++i) {
+		if (idx.index_at(pre[i]) != index_ref(pre[i]))
+			return false;
+	}
+	const pointi org = idx.origin();
+	std::uniform_int_distribution<int> pos(-20, static_cast<int>(pre.back()) + 20), len(0, 60);
+	for (int k = 0; k < 50; ++k) {
+		const int lo = pos(rng), n = len(rng);
+		const rectn vp = O == orientation::vert ? rectn::from_size(org.x - 7, org.y + lo, 3, static_cast<unsigned>(n))
+			: rectn::from_size(org.x + lo, org.y + 9, static_cast<unsigned>(n), 3);
+		const auto r = idx.visible_range(vp);
+		/// every non-empty item overlapping [lo, lo + n) and nothing else but zero extent items
+		for (std::size_t i = 0; i < ext.size(); ++i) {
+			const bool overlaps = n > 0 && ext[i] != 0 && static_cast<std::int64_t>(pre[i]) < lo + n && static_cast<std::int64_t>(pre[i + 1]) > lo;
+			const bool in = i >= r.first && i < r.last;
+			if (overlaps != in && ext[i] != 0)
+				return false;
+		}
+		if (r.last > ext.size())
+			return false;
+	}
+	return true;
+}
+
+} //ns
+
+int main() {
+	std::mt19937 rng(17);
+	for (const std::size_t n : { 0u, 1u, 2u, 7u, 8u, 9u, 100u, 513u }) {
+		std::uniform_int_distribution<unsigned> e(0, 40);
+		std::vector<unsigned> ext(n);
+		for (auto & v : ext)
+			v = rng() % 4 == 0 ? 0u : e(rng);
+		/// bulk build and push_back give the same index
+		item_extent_index<orientation::vert> built(pointi{5, -30}, 100, ext);
+		item_extent_index<orientation::hor> pushed(pointi{-3, 4}, 20);
+		for (const auto v : ext)
+			pushed.push_back(v);
+		CHECK(matches(built, ext, rng));
+		CHECK(matches(pushed, ext, rng));
+		for (int k = 0; k < 40 && n != 0; ++k) {
+			const std::size_t i = rng() % n;
+			ext[i] = rng() % 3 == 0 ? 0u : e(rng);
+			built.set_extent(i, ext[i]);
+			pushed.set_extent(i, ext[i]);
+			if (k % 8 == 0) {
+				ext.push_back(e(rng));
+				built.push_back(ext.back());
+				pushed.push_back(ext.back());
+				++k;
+			}
+			CHECK(matches(built, ext, rng));
+			CHECK(matches(pushed, ext, rng));
+		}
+		for (std::size_t i = 0; i < ext.size(); ++i) {
+			const int off = static_cast<int>(built.offset(i));
+			CHECK(built.item_rect(i) == rectn::from_size(5, -30 + off, 100u, ext[i]));
+			CHECK(pushed.item_rect(i) == rectn::from_size(-3 + off, 4, ext[i], 20u));
+		}
+		CHECK_THROWS(std::out_of_range, built.item_rect(ext.size()));
+		CHECK_THROWS(std::out_of_range, built.offset(ext.size() + 1));
+	}
+
+	/// offsets past the int range are reported by item_rect instead of wrapping
+	const std::vector<unsigned> huge{ 2000000000u, 2000000000u, 5u };
+	item_extent_index<orientation::vert> h(pointi{0, 0}, 10, huge);
+	CHECK(h.offset(2) == 4000000000u && h.index_at(3999999999u) == 1 && h.index_at(4000000004u) == 2);
+	CHECK(h.item_rect(0) == rectn::from_size(0, 0, 10u, 2000000000u));
+	CHECK_THROWS(std::out_of_range, h.item_rect(1));
+	CHECK_THROWS(std::out_of_range, h.item_rect(2));
+	h.set_origin(pointi{0, -2000000000});
+	CHECK(h.item_rect(1) == rectn::from_size(0, 0, 10u, 2000000000u));
+	CHECK(h.item_rect(2) == rectn::from_size(0, 2000000000, 10u, 5u));
+	return geom_test::failures;
+}
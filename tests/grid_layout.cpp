@@ -0,0 +1,35 @@
+#include "include/geom.h"
+#include "include/geom_grid_layout.h"
+#include "check.h"
+
+using namespace geom;
+using track = grid_layout::track;
+
+int main() {
+	grid_layout g;
+	g.set_columns({track::fixed(10), track::fr(1), track::fr(1)});
+	g.set_rows({track::automatic(5)});
+	g.add_item({0, 0, 1, 2, {0, 8}});
+	g.add_item({0, 2});
+	auto r = g.layout(rectn(0, 0, 110, 100));
+	CHECK(r.size() == 2);
+	/// the automatic row grows to the content of the single row item
+	CHECK(r[0] == rectn(0, 0, 60, 8));
+	CHECK(r[1] == rectn(60, 0, 110, 8));
+	CHECK_THROWS(std::out_of_range, g.add_item({1, 0}));
+
+	/// tracks cannot shrink under existing items, the grid is left unchanged
+	CHECK_THROWS(std::out_of_range, g.set_columns({track::fixed(10)}));
+	CHECK_THROWS(std::out_of_range, g.set_rows({}));
+	CHECK(g.layout(rectn(0, 0, 110, 100))[1] == rectn(60, 0, 110, 8));
+
+	/// growing is fine, shrinking after clear_items() too
+	g.set_columns({track::fixed(10), track::fr(1), track::fr(1), track::fixed(20)});
+	CHECK(g.layout(rectn(0, 0, 110, 100))[1] == rectn(50, 0, 90, 8));
+	g.clear_items();
+	g.set_columns({track::fixed(10)});
+	g.add_item({0, 0});
+	r = g.layout(rectn(0, 0, 110, 100));
+	CHECK(r.size() == 1 && r[0] == rectn(0, 0, 10, 5));
+	return geom_test::failures;
+}
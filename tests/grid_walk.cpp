@@ -0,0 +1,99 @@
+#include "include/geom.h"
+#include "include/geom_grid_walk.h"
+#include "check.h"
+
+#include <cstdlib>
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+template <typename T>
+std::vector<pointi> walk(point<T> origin, size<T> cell, point<T> a, point<T> b) {
+	std::vector<pointi> v;
+	for (const auto & c : grid_walk<T>(origin, cell, a, b))
+		v.push_back(c);
+	return v;
+}
+
+/// count, 4-connectivity, direction and end cells of a walk
+template <typename T>
+bool valid(point<T> origin, size<T> cell, point<T> a, point<T> b) {
+	const grid_walk<T> w(origin, cell, a, b);
+	const auto v = walk(origin, cell, a, b);
+	const pointi first{ detail::floor_cell<T>(a.x - origin.x, cell.width), detail::floor_cell<T>(a.y - origin.y, cell.height) };
+	const pointi last{ detail::floor_cell<T>(b.x - origin.x, cell.width), detail::floor_cell<T>(b.y - origin.y, cell.height) };
+	const auto n = static_cast<std::size_t>(1 + std::abs(last.x - first.x) + std::abs(last.y - first.y));
+	if (v.size() != n || w.size() != n || v.front() != first || v.back() != last)
+		return false;
+	for (std::size_t i = 1; i < v.size(); ++i) {
+		const int dx = v[i].x - v[i - 1].x, dy = v[i].y - v[i - 1].y;
+		if (std::abs(dx) + std::abs(dy) != 1)
+			return false;
+		/// never steps away from the last cell
+		if ((dx != 0 && (dx > 0) != (last.x > first.x)) || (dy != 0 && (dy > 0) != (last.y > first.y)))
+			return false;
+	}
+	return true;
+}
+
+} //ns
+
+int main() {
+	/// exact corner hits step x first
+	CHECK(walk<int>({0, 0}, {10, 10}, {5, 5}, {25, 25}) == std::vector<pointi>{{0, 0}, {1, 0}, {1, 1}, {2, 1}, {2, 2}});
+	CHECK(walk<int>({0, 0}, {10, 10}, {25, 25}, {5, 5}) == std::vector<pointi>{{2, 2}, {1, 2}, {1, 1}, {0, 1}, {0, 0}});
+	CHECK(walk<float>({0, 0}, {1, 1}, {.5f, .5f}, {2.5f, -1.5f}) == std::vector<pointi>{{0, 0}, {1, 0}, {1, -1}, {2, -1}, {2, -2}});
+	/// endpoints on boundaries belong to the cell right / below of them
+	CHECK(walk<int>({0, 0}, {10, 10}, {10, 5}, {0, 5}) == std::vector<pointi>{{1, 0}, {0, 0}});
+	CHECK(walk<int>({0, 0}, {10, 10}, {0, 0}, {20, 0}) == std::vector<pointi>{{0, 0}, {1, 0}, {2, 0}});
+	CHECK(walk<int>({0, 0}, {10, 10}, {0, 10}, {0, -10}) == std::vector<pointi>{{0, 1}, {0, 0}, {0, -1}});
+	/// negative cells and a shifted origin
+	CHECK(walk<int>({0, 0}, {10, 10}, {-5, -5}, {-5, -5}) == std::vector<pointi>{{-1, -1}});
+	CHECK(walk<int>({3, -7}, {4, 5}, {2, -8}, {3, -7}) == std::vector<pointi>{{-1, -1}, {0, -1}, {0, 0}});
+	CHECK(walk<double>({0, 0}, {2, 2}, {-.5, -3.}, {-.5, 1.}) == std::vector<pointi>{{-1, -2}, {-1, -1}, {-1, 0}});
+	CHECK_THROWS(std::invalid_argument, grid_walk<int>({0, 0}, {0, 10}, {0, 0}, {1, 1}));
+	CHECK_THROWS(std::invalid_argument, grid_walk<float>({0, 0}, {1, -1}, {0, 0}, {1, 1}));
+
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<int> coord(-60, 60), small(1, 12);
+	for (int i = 0; i < 20000; ++i) {
+		/// cell multiples put many endpoints and crossings exactly on boundaries and corners
+		const int w = small(rng);
+		const sizei c{ w, i % 3 == 0 ? small(rng) : w };
+		const pointi org{ coord(rng) % 7, coord(rng) % 7 };
+		pointi a{ coord(rng), coord(rng) }, b{ coord(rng), coord(rng) };
+		if (i % 4 == 0) {
+			a = { org.x + c.width * (coord(rng) / 10), org.y + c.height * (coord(rng) / 10) };
+			const int k = coord(rng) / 10;
+			b = { a.x + c.width * k, a.y + c.height * (i % 8 == 0 ? k : -k) };
+		}
+		CHECK(valid<int>(org, c, a, b));
+		const pointf af{ static_cast<float>(a.x) / 4.f, static_cast<float>(a.y) / 4.f }, bf{ static_cast<float>(b.x) / 4.f, static_cast<float>(b.y) / 4.f };
+		CHECK(valid<float>({0.f, 0.f}, {static_cast<float>(c.width) / 4.f, static_cast<float>(c.height) / 4.f}, af, bf));
+	}
+
+	/// grid_walk_cells keeps the in grid part of the full walk, in order, up to max_cells
+	const unsigned columns = 7, rows = 5;
+	std::vector<segment<int>> segs;
+	for (int i = 0; i < 2000; ++i)
+		segs.push_back({ { coord(rng), coord(rng) }, { coord(rng), coord(rng) } });
+	segs.push_back({ {-10, -10}, {80, 80} }); /// enters and leaves through grid corners
+	segs.push_back({ {-5, 0}, {-5, 40} }); /// outside
+	for (const std::size_t max_cells : { std::size_t{1}, std::size_t{3}, std::numeric_limits<std::size_t>::max() }) {
+		std::vector<std::uint32_t> cells;
+		std::vector<std::size_t> offsets;
+		grid_walk_cells<int>({0, 0}, {10, 10}, columns, rows, segs, cells, offsets, max_cells);
+		CHECK(offsets.size() == segs.size() + 1 && offsets.back() == cells.size());
+		for (std::size_t i = 0; i < segs.size(); ++i) {
+			std::vector<std::uint32_t> ref;
+			for (const auto & c : walk<int>({0, 0}, {10, 10}, segs[i].a, segs[i].b)) {
+				if (ref.size() < max_cells && c.x >= 0 && c.y >= 0 && c.x < static_cast<int>(columns) && c.y < static_cast<int>(rows))
+					ref.push_back(static_cast<std::uint32_t>(c.y) * columns + static_cast<std::uint32_t>(c.x));
+			}
+			CHECK(std::vector<std::uint32_t>(cells.begin() + static_cast<std::ptrdiff_t>(offsets[i]), cells.begin() + static_cast<std::ptrdiff_t>(offsets[i + 1])) == ref);
+		}
+	}
+	return geom_test::failures;
+}
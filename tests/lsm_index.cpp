@@ -0,0 +1,92 @@
+#include "include/geom.h"
+#include "include/geom_lsm_index.h"
+#include "check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace geom;
+
+int main() {
+	std::mt19937 g(3);
+
+	/// range decompositions cover every cell of the box, exactly when the budget allows it
+	for (int t = 0; t < 200; ++t) {
+		std::uniform_int_distribution<unsigned> c(0, 300);
+		const unsigned x1 = c(g), y1 = c(g), x2 = x1 + c(g) % 40, y2 = y1 + c(g) % 40;
+		for (std::size_t max_ranges : {1u, 8u, 64u, 100000u}) {
+			const auto rs = detail::morton_ranges(x1, y1, x2, y2, max_ranges);
+			CHECK(rs.size() <= std::max<std::size_t>(max_ranges, 4u));
+			for (std::size_t i = 1; i < rs.size(); ++i)
+				CHECK(rs[i].first > rs[i - 1].second + 1);
+			bool covered = true;
+			for (unsigned x = x1; x <= x2; ++x)
+				for (unsigned y = y1; y <= y2; ++y) {
+					const auto code = detail::morton_spread16(x) | detail::morton_spread16(y) << 1;
+					covered &= std::any_of(rs.begin(), rs.end(), [&](const auto & r) { return r.first <= code && code <= r.second; });
+				}
+			CHECK(covered);
+			if (max_ranges == 100000u) {
+				std::uint64_t cells = 0;
+				for (const auto & r : rs)
+					cells += r.second - r.first + 1;
+				CHECK(cells == std::uint64_t{x2 - x1 + 1} * (y2 - y1 + 1));
+			}
+		}
+	}
+
+	/// small buffer and fanout so that inserts keep the merge thread busy while a reader queries
+	lsm_point_index<float> idx(rectf(0.f, 0.f, 1000.f, 1000.f), 1000, 3, 16);
+	std::uniform_real_distribution<float> d(-10.f, 1010.f);
+	std::vector<pointf> pts;
+	std::atomic<bool> done{false};
+	std::atomic<int> reader_failures{0};
+	std::thread reader([&] {
+		std::mt19937 rg(9);
+		while (!done) {
+			const float x = std::uniform_real_distribution<float>(0.f, 900.f)(rg);
+			std::vector<bool> seen(idx.size() + 100000);
+			idx.query(rectf(x, x, x + 100.f, x + 100.f), [&](std::uint64_t id, const pointf & p) {
+				/// every point once, even while runs are swapped under the reader
+				if (!(p.x >= x && p.x < x + 100.f) || (id < seen.size() && seen[id]))
+					++reader_failures;
+				if (id < seen.size())
+					seen[id] = true;
+			});
+		}
+	});
+	for (std::uint64_t i = 0; i < 100000; ++i) {
+		pts.push_back({d(g), d(g)});
+		CHECK(idx.insert(pts.back()) == i);
+	}
+	done = true;
+	reader.join();
+	CHECK(reader_failures == 0);
+	CHECK(idx.size() == pts.size());
+
+	const auto compare = [&] {
+		for (int t = 0; t < 100; ++t) {
+			const float x = d(g), y = d(g);
+			const rectf q(x, y, x + 60.f, y + 40.f);
+			std::vector<std::uint64_t> got, want;
+			idx.query(q, [&](std::uint64_t id, const pointf &) { got.push_back(id); });
+			for (std::size_t i = 0; i < pts.size(); ++i)
+				if (q.contains(pts[i]))
+					want.push_back(i);
+			std::sort(got.begin(), got.end());
+			CHECK(got == want);
+		}
+	};
+	compare();
+	idx.flush();
+	idx.wait_idle();
+	compare();
+
+	int hits = 0;
+	idx.query(rectf(0.f, 0.f, 1000.f, 1000.f), [&](std::uint64_t, const pointf &) { return ++hits < 7; });
+	CHECK(hits == 7);
+	return geom_test::failures;
+}
@@ -0,0 +1,115 @@
+#include "include/geom.h"
+#include "include/geom_marquee.h"
+#include "check.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+/// ids hit by a full rescan of all objects
+std::vector<std::uint32_t> rescan(const std::vector<recti> & objects, const recti & m, marquee_mode mode) {
+	std::vector<std::uint32_t> ids;
+	for (std::uint32_t id = 0; id < objects.size(); ++id) {
+		const auto & b = objects[id];
+		const bool hit = mode == marquee_mode::contains ? m.contains(b)
+			: !m.empty() && b.left() < m.right() && m.left() < b.right() && b.top() < m.bottom() && m.top() < b.bottom();
+		if (hit)
+			ids.push_back(id);
+	}
+	return ids;
+}
+
+std::vector<std::uint32_t> sorted(std::vector<std::uint32_t> v) {
+	std::sort(v.begin(), v.end());
+	return v;
+}
+
+std::vector<std::uint32_t> minus(const std::vector<std::uint32_t> & a, const std::vector<std::uint32_t> & b) {
+	std::vector<std::uint32_t> d;
+	std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(d));
+	return d;
+}
+
+/// marquee spanned by the drag anchor and the cursor
+recti drag(pointi anchor, pointi cursor) {
+	return recti(std::min(anchor.x, cursor.x), std::min(anchor.y, cursor.y), std::max(anchor.x, cursor.x), std::max(anchor.y, cursor.y));
+}
+
+} //ns
+
+int main() {
+	/// for_each_difference covers a minus b exactly once with disjoint strips
+	std::mt19937 rng(23);
+	std::uniform_int_distribution<int> c(-6, 6);
+	for (int k = 0; k < 2000; ++k) {
+		const recti a = drag({c(rng), c(rng)}, {c(rng), c(rng)}), b = drag({c(rng), c(rng)}, {c(rng), c(rng)});
+		std::vector<recti> strips;
+		for_each_difference(a, b, [&](const recti & s) { strips.push_back(s); });
+		bool ok = true;
+		for (int y = -6; y < 6; ++y) {
+			for (int x = -6; x < 6; ++x) {
+				const recti unit(x, y, x + 1, y + 1);
+				const auto covers = [&](const recti & r) { return r.contains(unit); };
+				const auto n = std::count_if(strips.begin(), strips.end(), covers);
+				ok &= n == ((covers(a) && !covers(b)) ? 1 : 0);
+			}
+		}
+		for (const auto & s : strips)
+			ok &= !s.empty();
+		CHECK(ok);
+	}
+
+	/// objects on a coarse lattice share edges with marquees, some have zero size
+	std::vector<recti> objects;
+	std::uniform_int_distribution<int> p(0, 400), sz(0, 40);
+	for (int i = 0; i < 600; ++i) {
+		const int x = i % 3 == 0 ? p(rng) / 20 * 20 : p(rng), y = i % 3 == 0 ? p(rng) / 20 * 20 : p(rng);
+		objects.push_back(recti::from_size(x, y, i % 17 == 0 ? 0 : sz(rng), i % 19 == 0 ? 0 : sz(rng)));
+	}
+	grid_index<int> index(32);
+	for (std::uint32_t id = 0; id < objects.size(); ++id)
+		index.insert(id, objects[id]);
+
+	for (const auto mode : { marquee_mode::intersects, marquee_mode::contains }) {
+		marquee_selection<int> sel(index, mode);
+		for (int drags = 0; drags < 20; ++drags) {
+			const pointi anchor{ p(rng), p(rng) };
+			pointi cursor = anchor;
+			std::vector<std::uint32_t> added, removed;
+			sel.begin(drag(anchor, cursor), added);
+			auto expected = sorted(rescan(objects, drag(anchor, cursor), mode));
+			CHECK(sorted(added) == expected);
+			std::uniform_int_distribution<int> step(-60, 60);
+			for (int s = 0; s < 60; ++s) {
+				/// grow, shrink, cross the anchor, snap to lattice lines and collapse to zero size
+				if (s % 15 == 14)
+					cursor = anchor;
+				else if (s % 5 == 4)
+					cursor = { cursor.x / 20 * 20, cursor.y / 20 * 20 };
+				else
+					cursor = { std::clamp(cursor.x + step(rng), -20, 460), std::clamp(cursor.y + step(rng), -20, 460) };
+				const recti m = drag(anchor, cursor);
+				added.clear();
+				removed.clear();
+				sel.update(m, added, removed);
+				const auto now = sorted(rescan(objects, m, mode));
+				CHECK(sorted(added) == minus(now, expected));
+				CHECK(sorted(removed) == minus(expected, now));
+				CHECK(sorted(std::vector<std::uint32_t>(sel.selection().begin(), sel.selection().end())) == now);
+				CHECK(sel.count() == now.size());
+				expected = now;
+			}
+			/// updating with the same marquee reports nothing
+			added.clear();
+			removed.clear();
+			sel.update(drag(anchor, cursor), added, removed);
+			CHECK(added.empty() && removed.empty());
+		}
+		sel.clear();
+		CHECK(sel.count() == 0 && !sel.is_selected(0));
+	}
+	return geom_test::failures;
+}
@@ -0,0 +1,62 @@
+#include "include/geom.h"
+#include "include/geom_nine_slice.h"
+#include "check.h"
+
+#include <array>
+#include <vector>
+
+using namespace geom;
+
+int main() {
+	/// all 9 slices in row major order
+	const auto all = nine_slice(recti(0, 0, 100, 50), recti(0, 0, 30, 30), insetsi::uniform(10));
+	CHECK(all.size() == 9);
+	CHECK(all[0].dst == recti(0, 0, 10, 10) && all[0].src == recti(0, 0, 10, 10));
+	CHECK(all[1].dst == recti(10, 0, 90, 10) && all[1].src == recti(10, 0, 20, 10));
+	CHECK(all[4].dst == recti(10, 10, 90, 40) && all[4].src == recti(10, 10, 20, 20));
+	CHECK(all[8].dst == recti(90, 40, 100, 50) && all[8].src == recti(20, 20, 30, 30));
+
+	/// zero insets cull their row / column, a center of zero size in dst or src is culled too
+	const auto no_left = nine_slice(recti(0, 0, 100, 50), recti(0, 0, 30, 30), insetsi{0, 10, 10, 10});
+	CHECK(no_left.size() == 6 && no_left[0].dst == recti(0, 0, 90, 10) && no_left[5].dst == recti(90, 40, 100, 50));
+	CHECK(nine_slice(recti(0, 0, 20, 50), recti(0, 0, 30, 30), insetsi::uniform(10)).size() == 6);
+	CHECK(nine_slice(recti(0, 0, 100, 50), recti(0, 0, 20, 20), insetsi::uniform(10)).size() == 4);
+	CHECK(nine_slice(recti(0, 0, 100, 50), recti(0, 0, 30, 30), insetsi::uniform(0)).size() == 1);
+	CHECK(nine_slice(recti(5, 5, 5, 5), recti(0, 0, 30, 30), insetsi::uniform(10)).empty());
+
+	/// borders wider than dst are scaled down together
+	const auto narrow = nine_slice(rectf(0.f, 0.f, 10.f, 40.f), rectf(0.f, 0.f, 32.f, 32.f), insetsf{12.f, 8.f, 4.f, 8.f});
+	CHECK(narrow.size() == 6 && narrow[0].dst == rectf(0.f, 0.f, 7.5f, 8.f) && narrow[1].dst == rectf(7.5f, 0.f, 10.f, 8.f));
+	CHECK(narrow[1].src == rectf(28.f, 0.f, 32.f, 8.f));
+
+	/// bulk over vectors: one shared src and insets are broadcast, packed output equals the scalar slices
+	const std::vector<recti> dst{ recti(0, 0, 100, 50), recti(0, 0, 20, 50), recti(5, 5, 5, 5), recti(-40, -40, -10, -10) };
+	const std::vector<recti> src{ recti(0, 0, 30, 30) };
+	const std::vector<insetsi> in{ insetsi::uniform(10) };
+	std::vector<slice_rects<int>> out(dst.size() * 9);
+	const std::size_t n = nine_slice(dst, src, in, out);
+	std::vector<slice_rects<int>> expected;
+	for (const auto & d : dst)
+		for (const auto & s : nine_slice(d, src[0], in[0]))
+			expected.push_back(s);
+	CHECK(n == expected.size() && n == 9 + 6 + 0 + 9);
+	bool same = true;
+	for (std::size_t i = 0; i < std::min(n, expected.size()); ++i)
+		same &= out[i].dst == expected[i].dst && out[i].src == expected[i].src;
+	CHECK(same);
+
+	/// one src and insets per widget, arrays and spans
+	const std::array<rectf, 2> fdst{ rectf(0.f, 0.f, 64.f, 64.f), rectf(0.f, 0.f, 64.f, 64.f) };
+	const std::array<rectf, 2> fsrc{ rectf(0.f, 0.f, 16.f, 16.f), rectf(16.f, 0.f, 32.f, 16.f) };
+	const std::array<insetsf, 2> fin{ insetsf::uniform(4.f), insetsf{0.f, 4.f, 0.f, 4.f} };
+	std::array<slice_rects<float>, 18> fout{};
+	CHECK(nine_slice(std::span(fdst), fsrc, fin, std::span(fout)) == 9 + 3);
+	CHECK(fout[9].dst == rectf(0.f, 0.f, 64.f, 4.f) && fout[9].src == rectf(16.f, 0.f, 32.f, 4.f));
+	CHECK(fout[11].dst == rectf(0.f, 60.f, 64.f, 64.f));
+
+	CHECK_THROWS(std::invalid_argument, nine_slice(dst, std::vector<recti>(2, src[0]), in, out));
+	CHECK_THROWS(std::invalid_argument, nine_slice(dst, src, std::vector<insetsi>(3, in[0]), out));
+	std::vector<slice_rects<int>> small(dst.size() * 9 - 1);
+	CHECK_THROWS(std::out_of_range, nine_slice(dst, src, in, small));
+	return geom_test::failures;
+}
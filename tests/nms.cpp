@@ -0,0 +1,127 @@
+#include "include/geom.h"
+#include "include/geom_nms.h"
+#include "check.h"
+
+#include <cmath>
+#include <numeric>
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+float iou_ref(const rectf_soa & b, std::size_t i, std::size_t j) {
+	const float w = std::max(std::min(b.x2[i], b.x2[j]) - std::max(b.x1[i], b.x1[j]), 0.f);
+	const float h = std::max(std::min(b.y2[i], b.y2[j]) - std::max(b.y1[i], b.y1[j]), 0.f);
+	const float in = w * h;
+	const float un = (b.x2[i] - b.x1[i]) * (b.y2[i] - b.y1[i]) + (b.x2[j] - b.x1[j]) * (b.y2[j] - b.y1[j]) - in;
+	return un > 0.f ? in / un : 0.f;
+}
+
+/// greedy nms over a stable descending score order, overlap tested as in nms() without the division
+std::vector<std::size_t> nms_ref(const rectf_soa & b, std::span<const float> scores, float threshold) {
+	std::vector<std::size_t> order(b.size());
+	std::iota(order.begin(), order.end(), std::size_t{0});
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return scores[x] > scores[y]; });
+	std::vector<bool> removed(b.size(), false);
+	std::vector<std::size_t> keep;
+	for (std::size_t a = 0; a < order.size(); ++a) {
+		if (removed[a])
+			continue;
+		const auto i = order[a];
+		keep.push_back(i);
+		const float ai = (b.x2[i] - b.x1[i]) * (b.y2[i] - b.y1[i]);
+		for (std::size_t c = a + 1; c < order.size(); ++c) {
+			const auto j = order[c];
+			const float w = std::max(std::min(b.x2[i], b.x2[j]) - std::max(b.x1[i], b.x1[j]), 0.f);
+			const float h = std::max(std::min(b.y2[i], b.y2[j]) - std::max(b.y1[i], b.y1[j]), 0.f);
+			const float in = w * h;
+			const float un = ai + (b.x2[j] - b.x1[j]) * (b.y2[j] - b.y1[j]) - in;
+			if (threshold * un < in)
+				removed[c] = true;
+		}
+	}
+	return keep;
+}
+
+} //ns
+
+int main() {
+	/// bitmask nms across the 64 box word boundaries, with clustered boxes and repeated scores
+	for (std::size_t n : {0u, 1u, 2u, 63u, 64u, 65u, 127u, 128u, 129u, 700u}) {
+		std::mt19937 g(static_cast<unsigned>(n));
+		std::uniform_real_distribution<float> c(0.f, 200.f), e(1.f, 40.f), jitter(-4.f, 4.f);
+		rectf_soa boxes;
+		std::vector<float> scores;
+		for (std::size_t i = 0; i < n; ++i) {
+			/// every other box is a near copy of the previous one so that many overlaps cross the threshold
+			if (i % 2 == 1) {
+				const auto p = boxes[i - 1];
+				boxes.push_back(rectf(p.left() + jitter(g), p.top() + jitter(g), p.right() + jitter(g) + 5.f, p.bottom() + jitter(g) + 5.f));
+			} else {
+				const float x = c(g), y = c(g);
+				boxes.push_back(rectf(x, y, x + e(g), y + e(g)));
+			}
+			/// only eight distinct scores, ties are broken by index
+			scores.push_back(static_cast<float>(g() % 8) / 8.f);
+		}
+		for (const float threshold : {0.f, .3f, .5f, .9f})
+			CHECK(nms(boxes, scores, threshold) == nms_ref(boxes, scores, threshold));
+	}
+
+	/// all scores equal and all boxes identical, only the first survives
+	{
+		rectf_soa boxes;
+		for (int i = 0; i < 130; ++i)
+			boxes.push_back(rectf(0.f, 0.f, 10.f, 10.f));
+		const std::vector<float> scores(130, 1.f);
+		CHECK(nms(boxes, scores, .5f) == std::vector<std::size_t>{0});
+	}
+
+	std::mt19937 g(7);
+	std::uniform_real_distribution<float> c(0.f, 100.f), e(0.f, 30.f);
+	for (std::size_t n : {0u, 1u, 3u, 4u, 5u, 17u, 64u, 131u}) {
+		rectf_soa boxes;
+		std::vector<float> scores;
+		for (std::size_t i = 0; i < n; ++i) {
+			const float x = c(g), y = c(g);
+			/// every seventh box is degenerate
+			boxes.push_back(i % 7 == 3 ? rectf(x, y, x, y) : rectf(x, y, x + e(g), y + e(g)));
+			scores.push_back(std::uniform_real_distribution<float>(0.f, 1.f)(g));
+		}
+		std::vector<float> m(n * n);
+		iou_matrix(boxes, m);
+		for (std::size_t i = 0; i < n; ++i)
+			for (std::size_t j = 0; j < n; ++j)
+				CHECK(std::abs(m[i * n + j] - iou_ref(boxes, i, j)) <= 1e-6f);
+
+		/// soft-nms against a quadratic reference that recomputes every overlap from the original boxes
+		for (const auto method : {soft_nms_method::linear, soft_nms_method::gaussian}) {
+			const auto r = soft_nms(boxes, scores, method, .3f, .5f, .05f);
+			std::vector<float> sc = scores;
+			std::vector<bool> live(n, true);
+			std::size_t k = 0;
+			for (;; ++k) {
+				std::size_t best = n;
+				for (std::size_t i = 0; i < n; ++i)
+					if (live[i] && sc[i] >= .05f && (best == n || sc[i] > sc[best]))
+						best = i;
+				if (best == n)
+					break;
+				CHECK(k < r.size() && r[k].index == best && std::abs(r[k].score - sc[best]) <= 1e-5f);
+				if (k >= r.size() || r[k].index != best)
+					break;
+				live[best] = false;
+				for (std::size_t j = 0; j < n; ++j) {
+					if (!live[j])
+						continue;
+					const float o = iou_ref(boxes, best, j);
+					sc[j] *= method == soft_nms_method::linear ? (o > .3f ? 1.f - o : 1.f) : std::exp(-o * o / .5f);
+					live[j] = sc[j] >= .05f;
+				}
+			}
+			CHECK(k == r.size());
+		}
+	}
+	return geom_test::failures;
+}
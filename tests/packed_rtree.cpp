@@ -0,0 +1,134 @@
+#include "include/geom.h"
+#include "include/geom_packed_rtree.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+bool overlaps(const rectf & a, const rectf & b) noexcept {
+	return std::max(a.left(), b.left()) < std::min(a.right(), b.right()) && std::max(a.top(), b.top()) < std::min(a.bottom(), b.bottom());
+}
+
+double distance2(const rectf & r, const pointf & p) noexcept {
+	const double dx = std::max({double(r.left()) - p.x, 0., p.x - double(r.right())});
+	const double dy = std::max({double(r.top()) - p.y, 0., p.y - double(r.bottom())});
+	return dx * dx + dy * dy;
+}
+
+/// files written with every node size and with external sort runs of several lengths
+void check_tree(const std::string & path, unsigned n, std::size_t node_size, std::size_t memory_items) {
+	std::mt19937 g(n * 7 + static_cast<unsigned>(node_size));
+	std::uniform_real_distribution<float> c(-1000.f, 1000.f), e(0.f, 10.f);
+	std::vector<rectf> rs;
+	{
+		packed_rtree_writer<float> w(path, node_size, memory_items);
+		for (unsigned i = 0; i < n; ++i) {
+			const float x = c(g), y = c(g);
+			rs.emplace_back(x, y, x + e(g), y + e(g));
+			CHECK(w.add(rs.back()) == i);
+		}
+		w.finish();
+	}
+	const packed_rtree<float> t(path);
+	CHECK(t.size() == n);
+	for (int k = 0; k < 100; ++k) {
+		const pointf p{c(g), c(g)};
+		const rectf q(p.x, p.y, p.x + 50.f, p.y + 30.f);
+		std::vector<std::uint64_t> got, want;
+		t.query(q, [&](std::uint64_t id, const rectf & r) { got.push_back(id); CHECK(r == rs[id]); });
+		for (unsigned i = 0; i < n; ++i)
+			if (overlaps(rs[i], q))
+				want.push_back(i);
+		std::sort(got.begin(), got.end());
+		CHECK(got == want);
+
+		got.clear();
+		want.clear();
+		t.query(p, [&](std::uint64_t id, const rectf &) { got.push_back(id); });
+		for (unsigned i = 0; i < n; ++i)
+			if (rs[i].contains(p))
+				want.push_back(i);
+		std::sort(got.begin(), got.end());
+		CHECK(got == want);
+
+		/// ties may come in any order, the distances must match the k smallest
+		const auto nn = t.nearest(p, 5);
+		std::vector<double> all;
+		for (const auto & r : rs)
+			all.push_back(distance2(r, p));
+		std::sort(all.begin(), all.end());
+		CHECK(nn.size() == std::min<std::size_t>(5, n));
+		for (std::size_t i = 0; i < nn.size(); ++i)
+			CHECK(nn[i].second == all[i] && distance2(rs[nn[i].first], p) == all[i]);
+	}
+	if (n != 0) {
+		const auto b = *t.bounds();
+		CHECK(std::all_of(rs.begin(), rs.end(), [&](const rectf & r) {
+			return b.left() <= r.left() && b.top() <= r.top() && r.right() <= b.right() && r.bottom() <= b.bottom();
+		}));
+	}
+	const std::set<std::uint64_t> ids(t.ids().begin(), t.ids().end());
+	CHECK(ids.size() == n);
+}
+
+} //ns
+
+int main() {
+	/// the first 65536 indices fill the 256 x 256 corner and consecutive cells are adjacent
+	{
+		std::vector<int> cell(65536, -1);
+		bool unique = true;
+		for (unsigned x = 0; x < 256; ++x)
+			for (unsigned y = 0; y < 256; ++y) {
+				const auto h = detail::hilbert_index(x, y);
+				if (h >= 65536 || cell[h] != -1)
+					unique = false;
+				else
+					cell[h] = static_cast<int>(x << 8 | y);
+			}
+		CHECK(unique);
+		bool adjacent = true;
+		for (int i = 1; unique && i < 65536; ++i)
+			adjacent &= std::abs((cell[i - 1] >> 8) - (cell[i] >> 8)) + std::abs((cell[i - 1] & 255) - (cell[i] & 255)) == 1;
+		CHECK(adjacent);
+	}
+
+	const auto dir = std::filesystem::temp_directory_path();
+	const std::string path = (dir / "geom_test_packed_rtree.hrt").string();
+	for (unsigned n : {0u, 1u, 2u, 16u, 17u, 1000u, 5000u})
+		for (std::size_t node_size : {2u, 4u, 16u})
+			for (std::size_t memory_items : {7u, 1000u, 1u << 20})
+				if (memory_items * 200u >= n) /// hundreds of sort runs are slow and cover nothing more
+					check_tree(path, n, node_size, memory_items);
+
+	/// files of another coordinate type, missing and damaged files are rejected
+	{
+		packed_rtree_writer<int, unsigned> w(path);
+		w.add(rect<int, unsigned>(0, 0, 10, 10));
+		w.add(rect<int, unsigned>(5, 5, 20, 20));
+		w.finish();
+	}
+	{
+		const packed_rtree<int, unsigned> t(path);
+		int hits = 0;
+		t.query(pointi{6, 6}, [&](std::uint64_t, const rect<int, unsigned> &) { ++hits; });
+		CHECK(hits == 2);
+	}
+	CHECK_THROWS(std::invalid_argument, packed_rtree<float>(path));
+	CHECK_THROWS(std::system_error, packed_rtree<float>((dir / "geom_test_missing.hrt").string()));
+	if (std::FILE * f = std::fopen(path.c_str(), "ab")) {
+		std::fputc(1, f);
+		std::fclose(f);
+	}
+	CHECK_THROWS(std::invalid_argument, packed_rtree<int, unsigned>(path));
+	std::filesystem::remove(path);
+	return geom_test::failures;
+}
@@ -0,0 +1,84 @@
+#include "include/geom.h"
+#include "include/geom_qbvh.h"
+#include "check.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+/// quantized child bounds are rounded outwards, queries must still return exactly the overlapping rects
+template <typename T, unsigned W, typename Q>
+void check_qbvh(unsigned n, T span, T max_size) {
+	std::mt19937 g(n + W);
+	const auto rnd = [&](T lo, T hi) {
+		if constexpr (std::is_integral_v<T>)
+			return std::uniform_int_distribution<T>(lo, hi)(g);
+		else
+			return std::uniform_real_distribution<T>(lo, hi)(g);
+	};
+	const auto random_rect = [&](T extent) {
+		const T x = rnd(-span, span), y = rnd(-span, span);
+		return rect<T>(x, y, x + rnd(T(1), extent), y + rnd(T(1), extent));
+	};
+	for (const auto method : {bvh_build::sah, bvh_build::morton}) {
+		std::vector<rect<T>> rs;
+		for (unsigned i = 0; i < n; ++i)
+			rs.push_back(random_rect(max_size));
+		quantized_bvh<T, T, W, Q> q(std::span<const rect<T>>(rs), method, 6);
+
+		const auto compare = [&] {
+			for (int t = 0; t < 300; ++t) {
+				const auto qr = random_rect(max_size * 3);
+				std::vector<unsigned> got, want;
+				q.query(qr, [&](unsigned id, const auto &) { got.push_back(id); });
+				for (unsigned i = 0; i < n; ++i)
+					if (std::max(rs[i].left(), qr.left()) < std::min(rs[i].right(), qr.right())
+							&& std::max(rs[i].top(), qr.top()) < std::min(rs[i].bottom(), qr.bottom()))
+						want.push_back(i);
+				std::sort(got.begin(), got.end());
+				CHECK(got == want);
+
+				const point<T> p{qr.left(), qr.top()};
+				got.clear();
+				want.clear();
+				q.query(p, [&](unsigned id, const auto &) { got.push_back(id); });
+				for (unsigned i = 0; i < n; ++i)
+					if (rs[i].contains(p))
+						want.push_back(i);
+				std::sort(got.begin(), got.end());
+				CHECK(got == want);
+			}
+		};
+		compare();
+		/// moved rects leave their node frames, refit must widen them
+		for (unsigned i = 0; i < n; i += 3) {
+			rs[i] = random_rect(max_size);
+			q.update(i, rs[i]);
+		}
+		q.refit();
+		compare();
+
+		unsigned hits = 0;
+		q.query(rect<T>(-span, -span, span, span), [&](unsigned, const auto &) { return ++hits < 5; });
+		CHECK(hits == std::min(n, 5u));
+	}
+}
+
+} //ns
+
+int main() {
+	for (unsigned n : {0u, 1u, 7u, 100u, 2000u}) {
+		check_qbvh<int, 4, std::uint8_t>(n, 100000, 500);
+		check_qbvh<int, 8, std::uint16_t>(n, 100000, 500);
+		check_qbvh<float, 4, std::uint16_t>(n, 1000.f, 5.f);
+		check_qbvh<float, 8, std::uint8_t>(n, 1000.f, 5.f);
+		/// near the int range and with rects far smaller than one quantization step
+		check_qbvh<int, 4, std::uint8_t>(n, 2000000000, 20000000);
+		check_qbvh<float, 8, std::uint8_t>(n, 1e6f, .01f);
+	}
+	return geom_test::failures;
+}
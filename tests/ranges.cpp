@@ -0,0 +1,54 @@
+#include "include/geom.h"
+#include "include/geom_ranges.h"
+#include "check.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+template <typename R>
+auto collect(R && r) {
+	std::vector<std::ranges::range_value_t<R>> v;
+	std::ranges::copy(r, std::back_inserter(v));
+	return v;
+}
+
+} //ns
+
+int main() {
+	const std::vector<recti> rects{ recti(0, 0, 10, 10), recti(20, 0, 30, 10), recti(-5, -5, 5, 5), recti(8, 8, 9, 9) };
+
+	CHECK(collect(rects | views::translated(1, 2)) == std::vector<recti>{ recti(1, 2, 11, 12), recti(21, 2, 31, 12), recti(-4, -3, 6, 7), recti(9, 10, 10, 11) });
+	CHECK(collect(rects | views::translated(pointi{1, 2})) == collect(rects | views::translated(1, 2)));
+	CHECK(collect(rects | views::expanded(1)) == std::vector<recti>{ recti(-1, -1, 11, 11), recti(19, -1, 31, 11), recti(-6, -6, 6, 6), recti(7, 7, 10, 10) });
+
+	/// rects only touching the clip are dropped, the others are intersected
+	const recti clip(0, 0, 20, 10);
+	CHECK(collect(rects | views::clipped(clip)) == std::vector<recti>{ recti(0, 0, 10, 10), recti(0, 0, 5, 5), recti(8, 8, 9, 9) });
+	CHECK(collect(std::vector<recti>{} | views::clipped(clip)).empty());
+
+	/// chains run lazily in one pass, clipped evaluates the adaptors before it again for the rects it keeps
+	int calls = 0;
+	auto counted = rects | std::views::transform([&calls](const recti & r) { ++calls; return r; });
+	auto chain = counted | views::translated(10, 0) | views::clipped(recti(10, 0, 30, 10)) | views::expanded(2);
+	CHECK(calls == 0);
+	CHECK(collect(chain) == std::vector<recti>{ recti(8, -2, 22, 12), recti(8, -2, 17, 7), recti(16, 6, 21, 11) });
+	CHECK(calls <= 4 + 3);
+
+	const std::vector<rectf> fr{ rectf(0.f, 0.f, 1.5f, 1.f), rectf(1.5f, 0.f, 2.5f, 1.f), rectf(-0.4f, 0.6f, 0.4f, 2.5f) };
+	CHECK(collect(fr | views::cast<int>) == std::vector<recti>{ recti(0, 0, 1, 1), recti(1, 0, 2, 1), recti(0, 0, 0, 2) });
+	/// rounding edges keeps neighbours adjacent
+	const auto r = collect(fr | views::rounded<>);
+	CHECK(r == std::vector<recti>{ recti(0, 0, 2, 1), recti(2, 0, 3, 1), recti(0, 1, 0, 3) });
+	CHECK(r[0].right() == r[1].left());
+
+	std::vector<recti> mut = rects;
+	translate_all(std::span(mut), 1, 2);
+	CHECK(mut == collect(rects | views::translated(1, 2)));
+	expand_all(std::span(mut), -1);
+	CHECK(mut[0] == recti(2, 3, 10, 11));
+	return geom_test::failures;
+}
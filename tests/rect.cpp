@@ -0,0 +1,18 @@
+#include "include/geom.h"
+#include "check.h"
+
+#include <stdexcept>
+
+using namespace geom;
+
+int main() {
+	const rectn r(10, 10, 30, 20);
+	CHECK(r.inflated(insetsi{1, 2, 3, 4}) == rectn(9, 8, 33, 24));
+	CHECK(r.deflated(insetsi{1, 2, 3, 4}) == rectn(11, 12, 27, 16));
+	/// negative insets shrink, the size of rectn cannot go below zero
+	CHECK(r.inflated(insetsi{-5, -2, -5, -2}) == rectn(15, 12, 25, 18));
+	CHECK_THROWS(std::invalid_argument, r.inflated(insetsi{-15, 0, -10, 0}));
+	CHECK_THROWS(std::invalid_argument, r.deflated(insetsi{0, 6, 0, 6}));
+	CHECK(recti(0, 0, 4, 4).inflated(insetsi{-3, -3, -3, -3}) == recti(3, 3, 1, 1));
+	return geom_test::failures;
+}
@@ -0,0 +1,122 @@
+#include "include/geom.h"
+#include "include/geom_rounded_rect.h"
+#include "check.h"
+
+#include <random>
+
+using namespace geom;
+
+namespace {
+
+/// exact distance to the outline (4 edges and 4 quarter arcs) in double, negative inside
+double analytic_distance(const rounded_rectf & rr, double x, double y) {
+	const double l = rr.bounds().left(), t = rr.bounds().top(), r = rr.bounds().right(), b = rr.bounds().bottom();
+	const auto & q = rr.radii();
+	const auto segment = [&](double x1, double y1, double x2, double y2) {
+		const double dx = x2 - x1, dy = y2 - y1, len = dx * dx + dy * dy;
+		const double s = len > 0. ? std::clamp(((x - x1) * dx + (y - y1) * dy) / len, 0., 1.) : 0.;
+		return std::hypot(x - x1 - s * dx, y - y1 - s * dy);
+	};
+	/// arc around (cx, cy) in the quadrant given by the signs (sx, sy)
+	const auto arc = [&](double cx, double cy, double rad, double sx, double sy) {
+		if ((x - cx) * sx >= 0. && (y - cy) * sy >= 0.)
+			return std::abs(std::hypot(x - cx, y - cy) - rad);
+		return std::min(std::hypot(x - (cx + sx * rad), y - cy), std::hypot(x - cx, y - (cy + sy * rad)));
+	};
+	const double d = std::min({
+		segment(l + q.top_left, t, r - q.top_right, t), segment(r, t + q.top_right, r, b - q.bottom_right),
+		segment(l + q.bottom_left, b, r - q.bottom_right, b), segment(l, t + q.top_left, l, b - q.bottom_left),
+		arc(l + q.top_left, t + q.top_left, q.top_left, -1., -1.), arc(r - q.top_right, t + q.top_right, q.top_right, 1., -1.),
+		arc(r - q.bottom_right, b - q.bottom_right, q.bottom_right, 1., 1.), arc(l + q.bottom_left, b - q.bottom_left, q.bottom_left, -1., 1.) });
+	const auto outside_corner = [&](double cx, double cy, double rad, double sx, double sy) {
+		return (x - cx) * sx > 0. && (y - cy) * sy > 0. && std::hypot(x - cx, y - cy) > rad;
+	};
+	const bool inside = l < x && x < r && t < y && y < b
+		&& !outside_corner(l + q.top_left, t + q.top_left, q.top_left, -1., -1.)
+		&& !outside_corner(r - q.top_right, t + q.top_right, q.top_right, 1., -1.)
+		&& !outside_corner(r - q.bottom_right, b - q.bottom_right, q.bottom_right, 1., 1.)
+		&& !outside_corner(l + q.bottom_left, b - q.bottom_left, q.bottom_left, -1., 1.);
+	return inside ? -d : d;
+}
+
+bool near(double a, double b, double tol = 1e-3) {
+	return std::abs(a - b) <= tol;
+}
+
+} //ns
+
+int main() {
+	static_assert(rounded_recti(recti(0, 0, 100, 50), 10).contains(3, 3));
+	static_assert(rounded_rectf(rectf(0.f, 0.f, 100.f, 50.f), 10.f).signed_distance(50.f, 25.f) == -25.f);
+
+	/// corners, half-open straight edges and the 64 bit corner test of integer rects
+	const rounded_recti ri(recti(0, 0, 100, 50), 10);
+	CHECK(ri.contains(3, 3) && !ri.contains(2, 3) && !ri.contains(0, 0));
+	CHECK(ri.contains(97, 47) && !ri.contains(99, 49) && !ri.contains(99, 0));
+	CHECK(ri.contains(50, 0) && ri.contains(0, 25) && ri.contains(99, 25) && !ri.contains(100, 25) && !ri.contains(50, 50));
+	CHECK(!ri.contains(-1, 25) && !ri.contains(50, -1));
+	const rounded_recti big(recti(-2000000000, -2000000000, 2000000000, 2000000000), 1000000000);
+	CHECK(big.contains(0, 0) && big.contains(-1999999999, 0) && !big.contains(-1999999999, -1999999999));
+
+	/// radii are clamped and scaled down together
+	CHECK(rounded_rectf(rectf(0.f, 0.f, 100.f, 50.f), corner_radii<float>{-5.f, 10.f, 10.f, 10.f}).radii() == (corner_radii<float>{0.f, 10.f, 10.f, 10.f}));
+	CHECK(rounded_rectf(rectf(0.f, 0.f, 100.f, 50.f), corner_radii<float>{80.f, 80.f, 0.f, 0.f}).radii() == (corner_radii<float>{50.f, 50.f, 0.f, 0.f}));
+
+	/// distances on edges, at the bounds corners and inside
+	const rounded_rectf rf(rectf(0.f, 0.f, 100.f, 50.f), corner_radii<float>{10.f, 20.f, 0.f, 5.f});
+	CHECK(rf.signed_distance(50.f, 0.f) == 0.f && rf.signed_distance(100.f, 30.f) == 0.f && rf.signed_distance(100.f, 50.f) == 0.f);
+	CHECK(near(rf.signed_distance(0.f, 0.f), 10. * (std::sqrt(2.) - 1.)) && near(rf.signed_distance(100.f, 0.f), 20. * (std::sqrt(2.) - 1.)));
+	CHECK(near(rf.signed_distance(10.f - 10.f / std::sqrt(2.f), 10.f - 10.f / std::sqrt(2.f)), 0.));
+	CHECK(rf.signed_distance(50.f, 25.f) == -25.f && rf.signed_distance(50.f, -3.f) == 3.f && rf.signed_distance(104.f, 53.f) == 5.f);
+
+	/// random rects against the analytic distance, contains agrees with the sign, bulk kernels with the scalar one
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> pos(-50.f, 50.f), ext(1.f, 80.f), unit(0.f, 1.f);
+	for (int k = 0; k < 300; ++k) {
+		const rectf b = rectf::from_size(pos(rng), pos(rng), ext(rng), ext(rng));
+		/// the per quadrant distance is exact while no radius exceeds half the shorter side
+		const float m = std::min(b.width(), b.height()) * 0.5f;
+		const rounded_rectf rr(b, k % 10 == 0 ? corner_radii<float>::uniform(m) : corner_radii<float>{m * unit(rng), m * unit(rng), m * unit(rng), m * unit(rng)});
+		std::vector<pointf> pts;
+		for (int i = 0; i < 103; ++i)
+			pts.push_back({ b.left() + (unit(rng) * 1.4f - .2f) * b.width(), b.top() + (unit(rng) * 1.4f - .2f) * b.height() });
+		/// the bounds corners and edge midpoints
+		pts.push_back({ b.left(), b.top() });
+		pts.push_back({ b.right(), b.bottom() });
+		pts.push_back({ b.center().x, b.top() });
+		pts.push_back({ b.left(), b.center().y });
+		std::vector<float> dist(pts.size()), cov(pts.size());
+		signed_distance(rr, pts, dist);
+		coverage(rr, pts, cov);
+		for (std::size_t i = 0; i < pts.size(); ++i) {
+			const float d = rr.signed_distance(pts[i]);
+			CHECK(near(d, analytic_distance(rr, pts[i].x, pts[i].y)));
+			CHECK(near(dist[i], d, 1e-4));
+			CHECK(near(cov[i], coverage(d), 1e-4));
+			if (std::abs(d) > 1e-3f)
+				CHECK(rr.contains(pts[i]) == (d < 0.f));
+		}
+	}
+
+	/// one point against many rects, including the scalar tail
+	std::vector<rounded_rectf> rrs;
+	for (int k = 0; k < 23; ++k) {
+		const rectf b = rectf::from_size(pos(rng), pos(rng), ext(rng), ext(rng));
+		rrs.emplace_back(b, corner_radii<float>{ext(rng), ext(rng), ext(rng), ext(rng)});
+	}
+	for (int k = 0; k < 50; ++k) {
+		const pointf pt{ pos(rng), pos(rng) };
+		for (const std::size_t n : { std::size_t{0}, std::size_t{3}, std::size_t{8}, rrs.size() }) {
+			std::vector<float> out(n);
+			signed_distance(pt, std::span<const rounded_rectf>(rrs.data(), n), out);
+			for (std::size_t i = 0; i < n; ++i)
+				CHECK(near(out[i], rrs[i].signed_distance(pt), 1e-4));
+		}
+	}
+
+	std::vector<float> shorter(2);
+	const std::vector<pointf> three{ {0.f, 0.f}, {1.f, 1.f}, {2.f, 2.f} };
+	CHECK_THROWS(std::out_of_range, signed_distance(rf, three, shorter));
+	CHECK_THROWS(std::out_of_range, signed_distance(pointf{0.f, 0.f}, rrs, shorter));
+	return geom_test::failures;
+}
@@ -0,0 +1,32 @@
+#include "include/geom.h"
+#include "include/geom_snap.h"
+#include "check.h"
+
+using namespace geom;
+
+int main() {
+	/// the dragged rect 9 stays in the index at its old place and is excluded from the queries
+	snap_index<int> s;
+	s.insert(1, recti(100, 0, 150, 10));
+	s.insert(2, recti(0, 0, 20, 10));
+	s.insert(9, recti(40, 0, 60, 10));
+
+	/// repeating the gap 1 -> 9 (40) would need the excluded rect, the real gap 2 -> 1 is 80
+	CHECK(!s.equal_spacing<orientation::hor>(recti(188, 0, 208, 10), 5, 9u).has_value());
+	const auto g = s.equal_spacing<orientation::hor>(recti(228, 0, 248, 10), 5, 9u);
+	CHECK(g && g->before == 1u && g->after == 1u && g->gap == 80 && g->delta == 2);
+	/// without exclude rect 9 is a regular neighbour
+	const auto h = s.equal_spacing<orientation::hor>(recti(188, 0, 208, 10), 5);
+	CHECK(h && h->before == 1u && h->gap == 40 && h->delta == 2);
+
+	/// same on the after side, mirrored
+	snap_index<int> m;
+	m.insert(1, recti(-150, 0, -100, 10));
+	m.insert(2, recti(-20, 0, 0, 10));
+	m.insert(9, recti(-60, 0, -40, 10));
+	CHECK(!m.equal_spacing<orientation::hor>(recti(-208, 0, -188, 10), 5, 9u).has_value());
+	const auto a = m.equal_spacing<orientation::hor>(recti(-248, 0, -228, 10), 5, 9u);
+	CHECK(a && a->before == 1u && a->gap == 80 && a->delta == -2);
+	CHECK(m.snapped(recti(-248, 0, -228, 10), 5, 9u) == recti(-250, 0, -230, 10));
+	return geom_test::failures;
+}
@@ -0,0 +1,152 @@
+#include "include/geom.h"
+#include "include/geom_snapshot_index.h"
+#include "check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+using index_t = snapshot_index<int>;
+constexpr int cell = 32;
+
+int cell_of(int v) noexcept { return v >= 0 ? v / cell : -((-(v + 1)) / cell) - 1; }
+
+/// query() reports every rect sharing a grid cell with q, once
+std::vector<index_t::id_type> expected(const std::map<index_t::id_type, recti> & items, const recti & q) {
+	std::vector<index_t::id_type> ids;
+	for (const auto & [id, r] : items)
+		if (cell_of(r.left()) <= cell_of(q.right()) && cell_of(q.left()) <= cell_of(r.right())
+				&& cell_of(r.top()) <= cell_of(q.bottom()) && cell_of(q.top()) <= cell_of(r.bottom()))
+			ids.push_back(id);
+	return ids;
+}
+
+std::vector<index_t::id_type> query(const index_t::snapshot & s, const recti & q) {
+	std::vector<index_t::id_type> ids;
+	s.query(q, [&](index_t::id_type id, const recti &) { ids.push_back(id); });
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+recti random_rect(std::mt19937 & g) {
+	std::uniform_int_distribution<int> c(-500, 500), e(0, 120);
+	const int x = c(g), y = c(g);
+	return recti(x, y, x + e(g), y + e(g));
+}
+
+} //ns
+
+int main() {
+	std::mt19937 g(5);
+	/// small bucket count so that cells collide in buckets
+	index_t idx(cell, 64, 4);
+	auto rd = idx.make_reader();
+	auto rd_before = idx.make_reader(); /// one pin per reader at a time
+	std::map<index_t::id_type, recti> items;
+
+	{
+		const auto s = rd.pin();
+		CHECK(s.version() == 0 && s.size() == 0 && query(s, recti(-1000, -1000, 1000, 1000)).empty());
+	}
+	for (int round = 0; round < 30; ++round) {
+		std::uniform_int_distribution<index_t::id_type> id(0, 199);
+		for (int k = 0; k < 40; ++k) {
+			const auto i = id(g);
+			const auto r = random_rect(g);
+			switch (g() % 3) {
+			case 0:
+				if (items.contains(i))
+					CHECK_THROWS(std::invalid_argument, idx.insert(i, r));
+				else
+					idx.insert(i, r), items.insert_or_assign(i, r);
+				break;
+			case 1:
+				CHECK(idx.erase(i) == (items.erase(i) == 1));
+				break;
+			default:
+				idx.update(i, r);
+				items.insert_or_assign(i, r);
+				break;
+			}
+		}
+		/// unpublished changes are invisible
+		const auto before = rd_before.pin();
+		const auto v = idx.publish();
+		CHECK(v == static_cast<std::uint64_t>(round + 1) && before.version() == v - 1);
+		const auto s = rd.pin();
+		CHECK(s.version() == v && s.size() == items.size() && idx.size() == items.size());
+		for (int q = 0; q < 50; ++q) {
+			const auto qr = random_rect(g);
+			CHECK(query(s, qr) == expected(items, qr));
+		}
+	}
+
+	/// an old pinned snapshot keeps answering from its own version while later ones are published
+	{
+		idx.reclaim();
+		CHECK(idx.retired_versions() == 0);
+		auto rd2 = idx.make_reader();
+		const auto old = rd2.pin();
+		const auto frozen = items;
+		std::vector<recti> qs;
+		for (int q = 0; q < 50; ++q)
+			qs.push_back(random_rect(g));
+		for (int round = 0; round < 10; ++round) {
+			for (int k = 0; k < 40; ++k) {
+				const auto i = static_cast<index_t::id_type>(g() % 200);
+				idx.update(i, random_rect(g));
+			}
+			idx.publish();
+			/// versions the pinned reader may still see are kept
+			CHECK(idx.reclaim() == 0);
+		}
+		CHECK(idx.retired_versions() == 10);
+		CHECK(old.size() == frozen.size());
+		for (const auto & q : qs)
+			CHECK(query(old, q) == expected(frozen, q));
+	}
+	/// unpinned, everything retired goes
+	CHECK(idx.reclaim() != 0 && idx.retired_versions() == 0);
+
+	/// readers run against the writer, every published version is consistent in itself
+	{
+		snapshot_index<int> shared_idx(cell, 256, 8);
+		std::atomic<bool> done{false};
+		std::atomic<int> reader_failures{0};
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 3; ++t)
+			readers.emplace_back([&] {
+				auto r = shared_idx.make_reader();
+				while (!done) {
+					const auto s = r.pin();
+					/// the writer keeps ids 0..count-1 in a row of equal size rects, all of them in one version
+					std::size_t n = 0;
+					s.query(recti(-100000, -100000, 100000, 100000), [&](index_t::id_type, const recti & rr) {
+						n += rr.width() == static_cast<int>(s.version() % 50 + 1);
+					});
+					if (n != s.size())
+						++reader_failures;
+				}
+			});
+		for (std::uint64_t v = 1; v <= 2000; ++v) {
+			const int w = static_cast<int>(v % 50 + 1);
+			for (index_t::id_type i = 0; i < 20; ++i)
+				shared_idx.update(i, recti(static_cast<int>(i) * 200, 0, static_cast<int>(i) * 200 + w, 10));
+			CHECK(shared_idx.publish() == v);
+		}
+		done = true;
+		for (auto & t : readers)
+			t.join();
+		CHECK(reader_failures == 0);
+		shared_idx.reclaim();
+		CHECK(shared_idx.retired_versions() == 0);
+	}
+	return geom_test::failures;
+}
@@ -0,0 +1,166 @@
+#include "include/geom.h"
+#include "include/geom_tiles.h"
+#include "check.h"
+
+#include <chrono>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+/// in-process tile source, fetch can be held at a gate, failures are scripted per key
+struct fake_source {
+	using raw_type = unsigned;
+	using tile_type = tile_key;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool open = true;
+	std::vector<tile_key> fetched;
+	std::vector<tile_key> saw_cancel; /// fetches that were cancelled while held at the gate
+	std::set<std::tuple<unsigned, unsigned, unsigned>> fail_once;
+	bool jitter = false;
+
+	std::optional<raw_type> fetch(const tile_key & k, const std::atomic<bool> & cancelled) {
+		std::unique_lock lock(mutex);
+		fetched.push_back(k);
+		cv.wait(lock, [this] { return open; });
+		if (cancelled) {
+			saw_cancel.push_back(k);
+			return std::nullopt;
+		}
+		if (fail_once.erase({k.level, k.x, k.y}))
+			return std::nullopt;
+		lock.unlock();
+		if (jitter)
+			std::this_thread::sleep_for(std::chrono::microseconds((k.x * 7 + k.y * 13) % 200));
+		return k.level << 16 | k.y << 8 | k.x;
+	}
+	std::optional<tile_type> decode(const tile_key & k, raw_type raw, const std::atomic<bool> &) {
+		if (raw != (k.level << 16 | k.y << 8 | k.x))
+			return std::nullopt;
+		return k;
+	}
+	void set_open(bool o) {
+		{
+			std::lock_guard lock(mutex);
+			open = o;
+		}
+		cv.notify_all();
+	}
+	std::size_t fetch_count(const tile_key & k) {
+		std::lock_guard lock(mutex);
+		return static_cast<std::size_t>(std::count(fetched.begin(), fetched.end(), k));
+	}
+};
+static_assert(tile_source<fake_source>);
+
+/// polls until nothing is pending, returns the delivered keys in delivery order
+template <typename Streamer>
+std::vector<tile_key> drain(Streamer & s) {
+	std::vector<tile_key> got;
+	while (s.pending() != 0) {
+		s.wait_front();
+		s.poll([&](const tile_key & k, const tile_key & t) { CHECK(k == t); got.push_back(k); });
+	}
+	return got;
+}
+
+const tile_grid grid{{1024, 1024}, {128, 128}};
+const rectf whole(0.f, 0.f, 1024.f, 1024.f);
+const sizeu out{1024, 1024};
+
+} //ns
+
+int main() {
+	/// finished tiles are handed over nearest to the center first, whatever order the workers finish in
+	{
+		fake_source src;
+		src.jitter = true;
+		thread_pool pool(4);
+		tile_streamer<fake_source> s(src, pool, grid);
+		s.set_viewport(whole, out);
+		const auto want = grid.needed(whole, out);
+		CHECK(want.size() == 64);
+		CHECK(drain(s) == want);
+		/// delivered tiles still in view are not loaded again
+		s.set_viewport(whole, out);
+		CHECK(s.pending() == 0);
+		CHECK(src.fetched.size() == want.size());
+	}
+
+	/// tiles leaving the viewport are cancelled, queued ones are never fetched
+	{
+		fake_source src;
+		src.set_open(false);
+		thread_pool pool(1);
+		tile_streamer<fake_source> s(src, pool, grid);
+		const rectf left(0.f, 0.f, 256.f, 256.f), right(768.f, 768.f, 1024.f, 1024.f);
+		s.set_viewport(left, {256, 256});
+		const auto left_keys = grid.needed(left, {256, 256});
+		CHECK(left_keys.size() == 4);
+		/// wait for the single worker to hold the first left tile at the gate
+		while (src.fetch_count(left_keys[0]) == 0)
+			std::this_thread::yield();
+		s.set_viewport(right, {256, 256});
+		src.set_open(true);
+		const auto got = drain(s);
+		CHECK(got == grid.needed(right, {256, 256}));
+		for (std::size_t i = 1; i < left_keys.size(); ++i)
+			CHECK(src.fetch_count(left_keys[i]) == 0);
+		CHECK(src.saw_cancel.size() == 1 && src.saw_cancel[0] == left_keys[0]);
+	}
+
+	/// failed tiles are skipped by poll() and loaded again by the next set_viewport()
+	{
+		fake_source src;
+		const auto keys = grid.needed(whole, out);
+		src.fail_once.insert({keys[0].level, keys[0].x, keys[0].y});
+		src.fail_once.insert({keys[9].level, keys[9].x, keys[9].y});
+		thread_pool pool(2);
+		tile_streamer<fake_source> s(src, pool, grid);
+		s.set_viewport(whole, out);
+		auto got = drain(s);
+		CHECK(got.size() == keys.size() - 2);
+		CHECK(std::find(got.begin(), got.end(), keys[0]) == got.end() && std::find(got.begin(), got.end(), keys[9]) == got.end());
+		s.set_viewport(whole, out);
+		CHECK(s.pending() == 2);
+		got = drain(s);
+		CHECK(got == (std::vector<tile_key>{keys[0], keys[9]}));
+		CHECK(src.fetch_count(keys[0]) == 2 && src.fetch_count(keys[1]) == 1);
+	}
+
+	/// a pool destroyed with queued jobs completes them, the streamer outliving it does not hang
+	{
+		fake_source src;
+		src.set_open(false);
+		std::optional<thread_pool> pool(std::in_place, 1u);
+		tile_streamer<fake_source> s(src, *pool, grid);
+		s.set_viewport(whole, out);
+		while (src.fetch_count(grid.needed(whole, out)[0]) == 0)
+			std::this_thread::yield();
+		std::thread opener([&] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			src.set_open(true);
+		});
+		pool.reset();
+		opener.join();
+		CHECK(src.fetched.size() == 64);
+	}
+	/// without workers every job is still queued at destruction and runs on the destroying thread
+	{
+		fake_source src;
+		std::optional<thread_pool> pool(std::in_place, 0u);
+		tile_streamer<fake_source> s(src, *pool, grid);
+		s.set_viewport(whole, out);
+		CHECK(src.fetched.empty());
+		pool.reset();
+		CHECK(src.fetched.size() == 64);
+		CHECK(drain(s) == grid.needed(whole, out));
+	}
+	return geom_test::failures;
+}
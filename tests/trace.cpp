@@ -0,0 +1,74 @@
+#define GEOM_TRACE
+#include "include/geom.h"
+#include "check.h"
+
+#include <cstdio>
+#include <latch>
+#include <thread>
+#include <vector>
+
+using namespace geom;
+
+namespace {
+
+/// walks the records of a trace file, returns the count or -1 when the file is malformed
+long count_records(const char * path) {
+	std::FILE * f = std::fopen(path, "rb");
+	if (!f)
+		return -1;
+	std::vector<unsigned char> buf;
+	unsigned char chunk[1 << 16];
+	for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), f)) != 0;)
+		buf.insert(buf.end(), chunk, chunk + n);
+	std::fclose(f);
+	std::remove(path);
+	if (buf.size() < sizeof(trace::magic))
+		return -1;
+	std::size_t i = sizeof(trace::magic);
+	long ops = 0;
+	while (i + 2 <= buf.size()) {
+		const auto op = static_cast<trace::op_code>(buf[i]);
+		if (!trace::known(op) || !trace::known(static_cast<trace::scalar>(buf[i + 1] & 15u)))
+			return -1;
+		i += 2 + trace::operand_size(op);
+		++ops;
+	}
+	return i == buf.size() ? ops : -1;
+}
+
+} //ns
+
+int main() {
+	const char * path = "geom_test_trace.bin";
+	CHECK(trace::start(path));
+	/// traced types are recorded, others compile and are skipped
+	CHECK(recti(0, 0, 10, 10).intersected(recti(5, 5, 20, 20)).has_value());
+	CHECK(rect<double>(0., 0., 1., 1.).intersected(rect<double>(.5, .5, 2., 2.)).has_value());
+	CHECK(rect<double>(0., 0., 1., 1.).contains(point<double>{.5, .5}));
+	CHECK(rectf(0.f, 0.f, 1.f, 1.f).contains(pointf{.5f, .5f}));
+	trace::stop();
+	CHECK(count_records(path) == 2);
+	CHECK(!trace::known(static_cast<trace::op_code>(0)) && !trace::known(static_cast<trace::scalar>(7)));
+
+	/// stop() writes out threads that are still running, including buffers that filled and flushed before
+	for (const int per_thread : {10, 5000}) {
+		CHECK(trace::start(path));
+		constexpr int threads = 4;
+		std::latch recorded(threads), stopped(1);
+		std::vector<std::thread> ts;
+		for (int t = 0; t < threads; ++t)
+			ts.emplace_back([&, t] {
+				for (int i = 0; i < per_thread; ++i)
+					(void)recti(t, i, t + 10, i + 10).united(recti(0, 0, 5, 5));
+				recorded.count_down();
+				stopped.wait();
+			});
+		recorded.wait();
+		trace::stop();
+		stopped.count_down();
+		for (auto & t : ts)
+			t.join();
+		CHECK(count_records(path) == long{threads} * per_thread);
+	}
+	return geom_test::failures;
+}